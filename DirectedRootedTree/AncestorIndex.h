@@ -0,0 +1,65 @@
+#ifndef ANCESTORINDEX_H
+#define ANCESTORINDEX_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "DirectedRootedTree.h"
+
+namespace tree_algorithms
+{
+
+// Answers ancestor and lowest common ancestor queries in O(1) after an O(n) build.
+// Every node is labelled with its preorder number and the last preorder number of its subtree,
+// the lowest common ancestor is the node with the smallest preorder number between the first visits
+// of the two nodes in the Euler tour, found by a sparse table of O(n log n) size.
+// Any structural edit of the tree makes the index stale until rebuild() is called,
+// queries on a stale index throw std::logic_error. The tree must outlive the index.
+template <typename T>
+class AncestorIndex : private DirectedRootedTree<T>::Listener
+{
+public:
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+public:
+    explicit AncestorIndex(DirectedRootedTree<T>& tree);
+    ~AncestorIndex();
+
+    AncestorIndex(const AncestorIndex&) = delete;
+    AncestorIndex& operator=(const AncestorIndex&) = delete;
+
+    bool valid() const;
+    void rebuild();
+
+    // A node is not an ancestor of itself.
+    // Nodes which are not in the tree throw std::out_of_range.
+    bool is_ancestor(const TreeNode* ancestor, const TreeNode* node) const;
+    const TreeNode* lowest_common_ancestor(const TreeNode* left, const TreeNode* right) const;
+    size_t depth(const TreeNode* node) const;
+
+private:
+    void node_added(const TreeNode* node) override;
+    void node_removing(const TreeNode* node) override;
+    void tree_replaced() override;
+
+    size_t index(const TreeNode* node) const;
+    void build_sparse_table();
+
+private:
+    DirectedRootedTree<T>& m_tree;
+    bool m_valid;
+
+    std::unordered_map<const TreeNode*, size_t> m_indexes;   // Preorder number of every node
+    std::vector<const TreeNode*> m_nodes;
+    std::vector<size_t> m_subtree_ends;     // Last preorder number in the subtree of the node
+    std::vector<size_t> m_depths;
+    std::vector<size_t> m_first_visits;     // Position of the first visit of the node in the Euler tour
+    std::vector< std::vector<size_t> > m_sparse_table;  // Minimums of the Euler tour ranges of 2^level length
+    std::vector<size_t> m_levels;           // Floor of log2 of every range length
+};
+
+}
+
+#include "AncestorIndexImpl.h"
+
+#endif // ANCESTORINDEX_H
@@ -0,0 +1,183 @@
+#ifndef ANCESTORINDEXIMPL_H
+#define ANCESTORINDEXIMPL_H
+
+#include "AncestorIndex.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+template <typename T>
+tree_algorithms::AncestorIndex<T>::AncestorIndex(DirectedRootedTree<T>& tree)
+    : m_tree(tree),
+      m_valid(false)
+{
+    rebuild();
+    m_tree.add_listener(this);
+}
+
+template <typename T>
+tree_algorithms::AncestorIndex<T>::~AncestorIndex()
+{
+    m_tree.remove_listener(this);
+}
+
+template <typename T>
+bool tree_algorithms::AncestorIndex<T>::valid() const
+{
+    return m_valid;
+}
+
+template <typename T>
+void tree_algorithms::AncestorIndex<T>::rebuild()
+{
+    m_indexes.clear();
+    m_nodes.clear();
+    m_subtree_ends.clear();
+    m_depths.clear();
+    m_first_visits.clear();
+    m_valid = true;
+
+    const DirectedRootedTree<T>& tree = m_tree;
+    if (!tree.root())
+    {
+        m_sparse_table.clear();
+        m_levels.clear();
+        return;
+    }
+
+    m_indexes.reserve(tree.size());
+    m_nodes.reserve(tree.size());
+    m_subtree_ends.resize(tree.size());
+    m_depths.reserve(tree.size());
+    m_first_visits.reserve(tree.size());
+
+    // The Euler tour holds the preorder numbers: a node is visited when entered and after each of its children
+    std::vector<size_t> euler_tour;
+    euler_tour.reserve(2 * tree.size() - 1);
+
+    // Nodes on the path from the root with the index of their next child to visit
+    std::vector< std::pair<const TreeNode*, size_t> > path(1, std::make_pair(tree.root(), size_t(0)));
+    m_indexes.emplace(tree.root(), 0);
+    m_nodes.push_back(tree.root());
+    m_depths.push_back(0);
+    m_first_visits.push_back(0);
+    euler_tour.push_back(0);
+    while (!path.empty())
+    {
+        const TreeNode* node = path.back().first;
+        size_t& next_child = path.back().second;
+        const size_t node_index = m_indexes[node];
+        if (next_child == node->children().size())
+        {
+            m_subtree_ends[node_index] = m_nodes.size() - 1;
+            path.pop_back();
+            if (!path.empty())
+            {
+                euler_tour.push_back(m_indexes[path.back().first]);
+            }
+            continue;
+        }
+
+        const TreeNode* child = node->children()[next_child++].get();
+        const size_t child_index = m_nodes.size();
+        m_indexes.emplace(child, child_index);
+        m_nodes.push_back(child);
+        m_depths.push_back(m_depths[node_index] + 1);
+        m_first_visits.push_back(euler_tour.size());
+        euler_tour.push_back(child_index);
+        path.emplace_back(child, 0);
+    }
+
+    m_sparse_table.assign(1, std::move(euler_tour));
+    build_sparse_table();
+}
+
+template <typename T>
+bool tree_algorithms::AncestorIndex<T>::is_ancestor(const TreeNode* ancestor, const TreeNode* node) const
+{
+    const size_t ancestor_index = index(ancestor);
+    const size_t node_index = index(node);
+    return ancestor_index < node_index && node_index <= m_subtree_ends[ancestor_index];
+}
+
+template <typename T>
+const typename tree_algorithms::AncestorIndex<T>::TreeNode*
+tree_algorithms::AncestorIndex<T>::lowest_common_ancestor(const TreeNode* left, const TreeNode* right) const
+{
+    size_t begin = m_first_visits[index(left)];
+    size_t end = m_first_visits[index(right)];
+    if (begin > end)
+    {
+        std::swap(begin, end);
+    }
+
+    // Ancestors precede their descendants in preorder, the common ancestor is the smallest number between the visits
+    const size_t level = m_levels[end - begin + 1];
+    const std::vector<size_t>& minimums = m_sparse_table[level];
+    return m_nodes[std::min(minimums[begin], minimums[end + 1 - (size_t(1) << level)])];
+}
+
+template <typename T>
+size_t tree_algorithms::AncestorIndex<T>::depth(const TreeNode* node) const
+{
+    return m_depths[index(node)];
+}
+
+template <typename T>
+void tree_algorithms::AncestorIndex<T>::node_added(const TreeNode*)
+{
+    m_valid = false;
+}
+
+template <typename T>
+void tree_algorithms::AncestorIndex<T>::node_removing(const TreeNode*)
+{
+    m_valid = false;
+}
+
+template <typename T>
+void tree_algorithms::AncestorIndex<T>::tree_replaced()
+{
+    m_valid = false;
+}
+
+template <typename T>
+size_t tree_algorithms::AncestorIndex<T>::index(const TreeNode* node) const
+{
+    if (!m_valid)
+    {
+        throw std::logic_error("Ancestor index is stale: the tree was edited after the last rebuild");
+    }
+    typename std::unordered_map<const TreeNode*, size_t>::const_iterator iter = m_indexes.find(node);
+    if (iter == m_indexes.end())
+    {
+        throw std::out_of_range("Node does not belong to the indexed tree");
+    }
+    return iter->second;
+}
+
+template <typename T>
+void tree_algorithms::AncestorIndex<T>::build_sparse_table()
+{
+    const size_t tour_length = m_sparse_table.front().size();
+    m_levels.assign(tour_length + 1, 0);
+    for (size_t length = 2; length <= tour_length; ++length)
+    {
+        m_levels[length] = m_levels[length / 2] + 1;
+    }
+
+    for (size_t level = 1; (size_t(1) << level) <= tour_length; ++level)
+    {
+        const std::vector<size_t>& previous = m_sparse_table[level - 1];
+        const size_t half = size_t(1) << (level - 1);
+        std::vector<size_t> minimums(tour_length + 1 - 2 * half);
+        for (size_t i = 0; i != minimums.size(); ++i)
+        {
+            minimums[i] = std::min(previous[i], previous[i + half]);
+        }
+        m_sparse_table.push_back(std::move(minimums));
+    }
+}
+
+#endif // ANCESTORINDEXIMPL_H
@@ -0,0 +1,63 @@
+#ifndef CACHELINEALIGNED_H
+#define CACHELINEALIGNED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Base of the types whose objects must start a cache line of their own, so that the objects used
+// by different threads do not share a line. operator new aligns over-aligned types only since C++17,
+// so objects and arrays created by new are aligned here.
+struct alignas(64) CacheLineAligned
+{
+    static const size_t cache_line_size = 64;
+
+    static void* operator new(size_t bytes);
+    static void* operator new[](size_t bytes);
+    static void operator delete(void* pointer) noexcept;
+    static void operator delete[](void* pointer) noexcept;
+
+private:
+    static void* allocate(size_t bytes);
+    static void release(void* pointer) noexcept;
+};
+
+inline void* CacheLineAligned::operator new(size_t bytes)
+{
+    return allocate(bytes);
+}
+
+inline void* CacheLineAligned::operator new[](size_t bytes)
+{
+    return allocate(bytes);
+}
+
+inline void CacheLineAligned::operator delete(void* pointer) noexcept
+{
+    release(pointer);
+}
+
+inline void CacheLineAligned::operator delete[](void* pointer) noexcept
+{
+    release(pointer);
+}
+
+inline void* CacheLineAligned::allocate(size_t bytes)
+{
+    // The allocated block is kept just before the aligned address
+    void* block = ::operator new(bytes + cache_line_size + sizeof(void*));
+    const uintptr_t address = reinterpret_cast<uintptr_t>(block) + sizeof(void*);
+    void** aligned = reinterpret_cast<void**>((address + cache_line_size - 1) & ~uintptr_t(cache_line_size - 1));
+    aligned[-1] = block;
+    return aligned;
+}
+
+inline void CacheLineAligned::release(void* pointer) noexcept
+{
+    if (pointer)
+    {
+        ::operator delete(static_cast<void**>(pointer)[-1]);
+    }
+}
+
+#endif // CACHELINEALIGNED_H
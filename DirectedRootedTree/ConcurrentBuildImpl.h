@@ -0,0 +1,136 @@
+#ifndef CONCURRENTBUILDIMPL_H
+#define CONCURRENTBUILDIMPL_H
+
+#include "DirectedRootedTree.h"
+
+#include <cstdint>
+#include <thread>
+
+template <typename T>
+const size_t DirectedRootedTree<T>::ConcurrentBuild::stripes_count;
+
+template <typename T>
+DirectedRootedTree<T>::ConcurrentBuild::Inserter::Inserter(ConcurrentBuild& build)
+    : m_build(build),
+      m_pool(new NodePool<TreeNode>()),
+      m_added_count(0)
+{
+
+}
+
+template <typename T>
+DirectedRootedTree<T>::ConcurrentBuild::Inserter::~Inserter()
+{
+    m_build.merge(*m_pool, m_added_count);
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::ConcurrentBuild::Inserter::add_child(TreeNode* parent, const T& value)
+{
+    return append_child(parent, value);
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::ConcurrentBuild::Inserter::add_child(TreeNode* parent, T&& value)
+{
+    return append_child(parent, std::move(value));
+}
+
+template <typename T>
+template <typename V>
+typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::ConcurrentBuild::Inserter::append_child(TreeNode* parent, V&& value)
+{
+    // The node is built outside of the lock, only linking it to the parent is serialized.
+    // It is destroyed by the pool of the tree, which takes over the slab of the inserter.
+    node_ptr_t child(m_pool->create(std::forward<V>(value), parent), NodeDeleter(m_build.m_tree.m_pool.get()));
+
+    Stripe& stripe = m_build.stripe(parent);
+    while (stripe.locked.exchange(true, std::memory_order_acquire))
+    {
+        while (stripe.locked.load(std::memory_order_relaxed))
+        {
+            std::this_thread::yield();
+        }
+    }
+    TreeNode* node = nullptr;
+    try
+    {
+        node = parent->add_child(std::move(child));
+    }
+    catch (...)
+    {
+        stripe.locked.store(false, std::memory_order_release);
+        // The pool of the tree is shared by the inserters, a node not linked yet goes back to the private one
+        m_pool->destroy(child.release());
+        throw;
+    }
+    stripe.locked.store(false, std::memory_order_release);
+
+    ++m_added_count;
+    return node;
+}
+
+template <typename T>
+DirectedRootedTree<T>::ConcurrentBuild::ConcurrentBuild(DirectedRootedTree& tree)
+    : m_tree(tree),
+      m_stripes(new Stripe[stripes_count]),
+      m_added_count(0)
+{
+    for (size_t i = 0; i != stripes_count; ++i)
+    {
+        m_stripes[i].locked.store(false);
+    }
+}
+
+template <typename T>
+DirectedRootedTree<T>::ConcurrentBuild::~ConcurrentBuild()
+{
+    if (m_added_count == 0)
+    {
+        return;
+    }
+    // Recomputing the aggregates could throw, the tree stays consistent without them
+    m_tree.m_size += m_added_count;
+    m_tree.m_value_hasher = nullptr;
+    m_tree.m_node_metrics = false;
+    m_tree.release_aggregates();
+    m_tree.notify_tree_replaced();
+}
+
+template <typename T>
+void DirectedRootedTree<T>::ConcurrentBuild::finish()
+{
+    if (m_added_count == 0)
+    {
+        return;
+    }
+    if (m_tree.m_aggregates_pool)
+    {
+        m_tree.allocate_aggregates();
+    }
+    if (m_tree.m_node_metrics)
+    {
+        m_tree.compute_node_metrics();
+    }
+    m_tree.compute_hashes();
+    m_tree.m_size += m_added_count;
+    m_added_count = 0;
+    m_tree.notify_tree_replaced();
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::ConcurrentBuild::Stripe& DirectedRootedTree<T>::ConcurrentBuild::stripe(const TreeNode* parent)
+{
+    // Nodes lie next to each other in the slabs, so neighbours get different stripes
+    return m_stripes[(reinterpret_cast<uintptr_t>(parent) / sizeof(TreeNode)) % stripes_count];
+}
+
+template <typename T>
+void DirectedRootedTree<T>::ConcurrentBuild::merge(NodePool<TreeNode>& pool, size_t added_count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tree.m_pool->adopt(pool);
+    m_added_count += added_count;
+}
+
+#endif // CONCURRENTBUILDIMPL_H
@@ -0,0 +1,73 @@
+#ifndef DIRECTEDACYCLICGRAPH_H
+#define DIRECTEDACYCLICGRAPH_H
+
+#include <utility>
+#include <vector>
+
+#include "DirectedRootedTree.h"
+
+// Dependency graph where a node can have several parents.
+// The structure is fixed at construction and kept in compressed sparse row form:
+// the successors (and predecessors) of all nodes are stored one after another in a single array.
+// An edge (from, to) means that "from" must be finished before "to".
+template <typename T>
+class DirectedAcyclicGraph
+{
+public:
+    typedef size_t node_index_t;
+    typedef std::pair<node_index_t, node_index_t> edge_t;
+
+    class AdjacentNodes
+    {
+    public:
+        AdjacentNodes(const node_index_t* begin, const node_index_t* end);
+
+        const node_index_t* begin() const;
+        const node_index_t* end() const;
+
+        size_t size() const;
+        bool empty() const;
+
+    private:
+        const node_index_t* m_begin;
+        const node_index_t* m_end;
+    };
+
+public:
+    DirectedAcyclicGraph();
+    // Throws std::out_of_range if an edge refers to a missing node
+    // and std::invalid_argument if the edges contain a cycle
+    DirectedAcyclicGraph(std::vector<T> values, const std::vector<edge_t>& edges);
+    // Nodes are numbered in preorder, the root is the node 0 and every edge goes from a parent to a child
+    explicit DirectedAcyclicGraph(const DirectedRootedTree<T>& tree);
+
+    // Nodes of a cycle in the order of the edges starting from the smallest index, empty if the edges are acyclic.
+    // Throws std::out_of_range if an edge refers to a missing node.
+    static std::vector<node_index_t> find_cycle(size_t nodes_count, const std::vector<edge_t>& edges);
+
+    size_t size() const;
+    size_t edges_count() const;
+
+    const T& value(node_index_t node) const;
+    T& value(node_index_t node);
+
+    AdjacentNodes successors(node_index_t node) const;
+    AdjacentNodes predecessors(node_index_t node) const;
+
+private:
+    void build_adjacency(const std::vector<edge_t>& edges);
+
+    static void fill_rows(size_t nodes_count, const std::vector<edge_t>& edges, bool by_source,
+                          std::vector<size_t>& offsets, std::vector<node_index_t>& columns);
+
+private:
+    std::vector<T> m_values;
+    std::vector<size_t> m_successor_offsets;    // Successors of node i occupy [offsets[i], offsets[i + 1])
+    std::vector<node_index_t> m_successors;
+    std::vector<size_t> m_predecessor_offsets;
+    std::vector<node_index_t> m_predecessors;
+};
+
+#include "DirectedAcyclicGraphImpl.h"
+
+#endif // DIRECTEDACYCLICGRAPH_H
@@ -0,0 +1,246 @@
+#ifndef DIRECTEDACYCLICGRAPHIMPL_H
+#define DIRECTEDACYCLICGRAPHIMPL_H
+
+#include "DirectedAcyclicGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+template <typename T>
+DirectedAcyclicGraph<T>::AdjacentNodes::AdjacentNodes(const node_index_t* begin, const node_index_t* end)
+    : m_begin(begin),
+      m_end(end)
+{
+
+}
+
+template <typename T>
+const typename DirectedAcyclicGraph<T>::node_index_t* DirectedAcyclicGraph<T>::AdjacentNodes::begin() const
+{
+    return m_begin;
+}
+
+template <typename T>
+const typename DirectedAcyclicGraph<T>::node_index_t* DirectedAcyclicGraph<T>::AdjacentNodes::end() const
+{
+    return m_end;
+}
+
+template <typename T>
+size_t DirectedAcyclicGraph<T>::AdjacentNodes::size() const
+{
+    return static_cast<size_t>(m_end - m_begin);
+}
+
+template <typename T>
+bool DirectedAcyclicGraph<T>::AdjacentNodes::empty() const
+{
+    return m_begin == m_end;
+}
+
+template <typename T>
+DirectedAcyclicGraph<T>::DirectedAcyclicGraph()
+    : m_successor_offsets(1, 0),
+      m_predecessor_offsets(1, 0)
+{
+
+}
+
+template <typename T>
+DirectedAcyclicGraph<T>::DirectedAcyclicGraph(std::vector<T> values, const std::vector<edge_t>& edges)
+    : m_values(std::move(values))
+{
+    if (!find_cycle(m_values.size(), edges).empty())
+    {
+        throw std::invalid_argument("Dependency graph contains a cycle");
+    }
+    build_adjacency(edges);
+}
+
+template <typename T>
+DirectedAcyclicGraph<T>::DirectedAcyclicGraph(const DirectedRootedTree<T>& tree)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    // A tree has no cycles, so the edges are taken as they are
+    m_values.reserve(tree.size());
+    std::vector<edge_t> edges;
+    edges.reserve(tree.size() - 1);
+
+    std::vector< std::pair<const TreeNode*, node_index_t> > pending(1, std::make_pair(tree.root(), node_index_t(0)));
+    while (!pending.empty())
+    {
+        const TreeNode* node = pending.back().first;
+        const node_index_t index = m_values.size();
+        if (index != 0)
+        {
+            edges.emplace_back(pending.back().second, index);
+        }
+        pending.pop_back();
+        m_values.push_back(node->value());
+
+        const typename DirectedRootedTree<T>::node_children_t& children = node->children();
+        for (auto iter = children.rbegin(); iter != children.rend(); ++iter)
+        {
+            pending.emplace_back(iter->get(), index);
+        }
+    }
+    build_adjacency(edges);
+}
+
+template <typename T>
+std::vector<typename DirectedAcyclicGraph<T>::node_index_t>
+DirectedAcyclicGraph<T>::find_cycle(size_t nodes_count, const std::vector<edge_t>& edges)
+{
+    for (const edge_t& edge : edges)
+    {
+        if (edge.first >= nodes_count || edge.second >= nodes_count)
+        {
+            throw std::out_of_range("Edge refers to a missing node");
+        }
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<node_index_t> successors;
+    fill_rows(nodes_count, edges, true, offsets, successors);
+
+    // Kahn's algorithm removes all nodes that are not on a cycle or behind one
+    std::vector<size_t> in_degrees(nodes_count, 0);
+    for (const edge_t& edge : edges)
+    {
+        ++in_degrees[edge.second];
+    }
+    std::vector<node_index_t> ready;
+    for (node_index_t node = 0; node != nodes_count; ++node)
+    {
+        if (in_degrees[node] == 0)
+        {
+            ready.push_back(node);
+        }
+    }
+    size_t removed_count = 0;
+    while (!ready.empty())
+    {
+        const node_index_t node = ready.back();
+        ready.pop_back();
+        ++removed_count;
+        for (size_t i = offsets[node]; i != offsets[node + 1]; ++i)
+        {
+            if (--in_degrees[successors[i]] == 0)
+            {
+                ready.push_back(successors[i]);
+            }
+        }
+    }
+    if (removed_count == nodes_count)
+    {
+        return std::vector<node_index_t>();
+    }
+
+    // Every remaining node has a remaining predecessor, so following them backwards ends up in a cycle
+    std::vector<size_t> predecessor_offsets;
+    std::vector<node_index_t> predecessors;
+    fill_rows(nodes_count, edges, false, predecessor_offsets, predecessors);
+
+    const size_t not_visited = static_cast<size_t>(-1);
+    std::vector<size_t> path_positions(nodes_count, not_visited);
+    std::vector<node_index_t> path;
+    node_index_t node = static_cast<node_index_t>(std::find_if(in_degrees.begin(), in_degrees.end(),
+                                                               [](size_t in_degree) -> bool
+    {
+        return in_degree != 0;
+    }) - in_degrees.begin());
+    while (path_positions[node] == not_visited)
+    {
+        path_positions[node] = path.size();
+        path.push_back(node);
+        for (size_t i = predecessor_offsets[node]; i != predecessor_offsets[node + 1]; ++i)
+        {
+            if (in_degrees[predecessors[i]] != 0)
+            {
+                node = predecessors[i];
+                break;
+            }
+        }
+    }
+    std::vector<node_index_t> cycle(path.begin() + path_positions[node], path.end());
+    std::reverse(cycle.begin(), cycle.end());
+    std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end()), cycle.end());
+    return cycle;
+}
+
+template <typename T>
+size_t DirectedAcyclicGraph<T>::size() const
+{
+    return m_values.size();
+}
+
+template <typename T>
+size_t DirectedAcyclicGraph<T>::edges_count() const
+{
+    return m_successors.size();
+}
+
+template <typename T>
+const T& DirectedAcyclicGraph<T>::value(node_index_t node) const
+{
+    return m_values[node];
+}
+
+template <typename T>
+T& DirectedAcyclicGraph<T>::value(node_index_t node)
+{
+    return m_values[node];
+}
+
+template <typename T>
+typename DirectedAcyclicGraph<T>::AdjacentNodes DirectedAcyclicGraph<T>::successors(node_index_t node) const
+{
+    return AdjacentNodes(m_successors.data() + m_successor_offsets[node],
+                         m_successors.data() + m_successor_offsets[node + 1]);
+}
+
+template <typename T>
+typename DirectedAcyclicGraph<T>::AdjacentNodes DirectedAcyclicGraph<T>::predecessors(node_index_t node) const
+{
+    return AdjacentNodes(m_predecessors.data() + m_predecessor_offsets[node],
+                         m_predecessors.data() + m_predecessor_offsets[node + 1]);
+}
+
+template <typename T>
+void DirectedAcyclicGraph<T>::build_adjacency(const std::vector<edge_t>& edges)
+{
+    fill_rows(m_values.size(), edges, true, m_successor_offsets, m_successors);
+    fill_rows(m_values.size(), edges, false, m_predecessor_offsets, m_predecessors);
+}
+
+template <typename T>
+void DirectedAcyclicGraph<T>::fill_rows(size_t nodes_count, const std::vector<edge_t>& edges, bool by_source,
+                                        std::vector<size_t>& offsets, std::vector<node_index_t>& columns)
+{
+    // Counting sort of the edges by the row node keeps the order of the edges inside of a row
+    offsets.assign(nodes_count + 1, 0);
+    for (const edge_t& edge : edges)
+    {
+        ++offsets[(by_source ? edge.first : edge.second) + 1];
+    }
+    for (size_t node = 0; node != nodes_count; ++node)
+    {
+        offsets[node + 1] += offsets[node];
+    }
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+    columns.resize(edges.size());
+    for (const edge_t& edge : edges)
+    {
+        if (by_source)
+        {
+            columns[positions[edge.first]++] = edge.second;
+        }
+        else
+        {
+            columns[positions[edge.second]++] = edge.first;
+        }
+    }
+}
+
+#endif // DIRECTEDACYCLICGRAPHIMPL_H
@@ -1,36 +1,66 @@
 #ifndef DIRECTEDROOTEDTREE_H
 #define DIRECTEDROOTEDTREE_H
 
+#include <atomic>
 #include <iterator>
+#include <mutex>
 #include <vector>
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
 #include <unordered_set>
 
+#include "CacheLineAligned.h"
+#include "NodePool.h"
+
 template <typename T>
 class DirectedRootedTree
 {
-    // TODO: Make this class copyable if T is copyable or clonable if T is movable and clonable but not copyable
+    // TODO: Make this class clonable if T is movable and clonable but not copyable
 
-    // TODO: make parameters const references
-    friend bool operator==(DirectedRootedTree& left, DirectedRootedTree& right)
+    friend bool operator==(const DirectedRootedTree& left, const DirectedRootedTree& right)
     {
         return equal(left, right);
     }
 
-    // TODO: make parameters const references
-    friend bool operator!=(DirectedRootedTree& left, DirectedRootedTree& right)
+    friend bool operator!=(const DirectedRootedTree& left, const DirectedRootedTree& right)
     {
         return !equal(left, right);
     }
 
+    // Kept aside from the node while structural hashing or node metrics are enabled
+    struct NodeAggregates
+    {
+        size_t hash;
+        size_t depth;
+        size_t subtree_size;
+        size_t height;
+        std::map<size_t, size_t> children_heights;  /*!< Children count by height of the child */
+    };
+
 public:
     class TreeNode;
+    class ConstIterator;
+
+    class NodeDeleter
+    {
+    public:
+        explicit NodeDeleter(NodePool<TreeNode>* pool = nullptr);
+
+        void operator()(TreeNode* node) const;
 
-    typedef std::vector< std::unique_ptr<TreeNode> > node_children_t;
+    private:
+        NodePool<TreeNode>* m_pool;
+    };
+
+    typedef std::unique_ptr<TreeNode, NodeDeleter> node_ptr_t;
+    typedef std::vector<node_ptr_t> node_children_t;
 
     class TreeNode
     {
         friend class DirectedRootedTree;
+        friend class NodePool<TreeNode>;
 
     public:
         const T& value() const;
@@ -40,22 +70,120 @@ public:
         TreeNode* parent();
 
         const node_children_t& children() const;
+        size_t child_index() const;
+
+        // Hash of the value and of the ordered children hashes, valid while structural hashing is enabled
+        size_t structural_hash() const;
+
+        // Valid while node metrics are enabled
+        size_t depth() const;
+        size_t subtree_size() const;    // The node is counted as well
+        size_t height() const;
 
     private:
         explicit TreeNode(const T& value, TreeNode* parent = nullptr);
         explicit TreeNode(T&& value, TreeNode* parent = nullptr);
 
-        TreeNode* add_child(std::unique_ptr<TreeNode>&& child);
+        TreeNode* add_child(node_ptr_t&& child);
 
     private:
         T m_value;
         TreeNode* m_parent;
+        size_t m_child_index;   // Position of the node in the children list of its parent
+        NodeAggregates* m_aggregates;   // Empty while structural hashing and node metrics are disabled
         node_children_t m_children;
     };
 
+    // Receives notifications about structural changes of the tree.
+    // Listeners are called synchronously and must not add or remove listeners from a notification.
+    class Listener
+    {
+    public:
+        virtual ~Listener() {}
+
+        // The node is already linked to its parent
+        virtual void node_added(const TreeNode* node);
+        // The node is still linked, its children are not moved yet
+        virtual void node_removing(const TreeNode* node);
+        // Removed nodes are unlinked, their children took their places in the children list of the parent
+        // at [first_child, first_child + children_count). remove_nodes notifies every such run of children once,
+        // a parent which lost only leaves is notified with no children.
+        virtual void node_removed(const TreeNode* parent, size_t first_child, size_t children_count);
+        // All nodes of the tree were replaced at once (moved in or out of the tree, or built concurrently).
+        // Must not throw: it is called from the noexcept move operations.
+        virtual void tree_replaced();
+        // The node still has the old value
+        virtual void value_changing(const TreeNode* node);
+        virtual void value_changed(const TreeNode* node);
+    };
+
+    // Session of adding nodes from several threads at once.
+    // Every thread adds nodes through its own Inserter, which allocates them from a private pool
+    // and counts them locally. Appending to the same parent from several threads is serialized
+    // by a lock striped over the parents, the order of such children is unspecified.
+    // While the session exists the tree must not be used in any other way.
+    // A destroyed inserter hands its slabs over to the pool of the tree, which reuses the slots
+    // of the removed nodes. finish() updates the size, the structural hashes and the node metrics
+    // and sends tree_replaced to the listeners.
+    class ConcurrentBuild
+    {
+    public:
+        class Inserter
+        {
+        public:
+            explicit Inserter(ConcurrentBuild& build);
+            ~Inserter();
+
+            Inserter(const Inserter&) = delete;
+            Inserter& operator=(const Inserter&) = delete;
+
+            TreeNode* add_child(TreeNode* parent, const T& value);
+            TreeNode* add_child(TreeNode* parent, T&& value);
+
+        private:
+            template <typename V>
+            TreeNode* append_child(TreeNode* parent, V&& value);
+
+        private:
+            ConcurrentBuild& m_build;
+            std::unique_ptr< NodePool<TreeNode> > m_pool;
+            size_t m_added_count;
+        };
+
+    public:
+        explicit ConcurrentBuild(DirectedRootedTree& tree);
+        // A session which is not finished, e.g. left by an exception, keeps the added nodes
+        // but disables structural hashing and node metrics of the tree
+        ~ConcurrentBuild();
+
+        ConcurrentBuild(const ConcurrentBuild&) = delete;
+        ConcurrentBuild& operator=(const ConcurrentBuild&) = delete;
+
+        // All inserters must be destroyed before. If it throws, the session is not finished and it can be retried
+        void finish();
+
+    private:
+        // Spin lock alone in a cache line
+        struct alignas(CacheLineAligned::cache_line_size) Stripe : CacheLineAligned
+        {
+            std::atomic<bool> locked;
+        };
+
+        static const size_t stripes_count = 256;
+
+        Stripe& stripe(const TreeNode* parent);
+        void merge(NodePool<TreeNode>& pool, size_t added_count);
+
+    private:
+        DirectedRootedTree& m_tree;
+        std::unique_ptr<Stripe[]> m_stripes;
+        std::mutex m_mutex;
+        size_t m_added_count;
+    };
+
     class Iterator : public std::iterator<std::forward_iterator_tag, T, size_t, T*, T&>
     {
-        // TODO: add const Iterator
+        friend class ConstIterator;
 
         friend bool operator==(const Iterator& left, const Iterator& right)
         {
@@ -79,42 +207,285 @@ public:
         TreeNode* current_node();
 
     private:
-        bool go_to_unviewed_child(const TreeNode* parent);
+        TreeNode* m_current_node;
+    };
+
+    class ConstIterator : public std::iterator<std::forward_iterator_tag, T, size_t, const T*, const T&>
+    {
+        friend bool operator==(const ConstIterator& left, const ConstIterator& right)
+        {
+            return left.m_current_node == right.m_current_node;
+        }
+
+        friend bool operator!=(const ConstIterator& left, const ConstIterator& right)
+        {
+            return left.m_current_node != right.m_current_node;
+        }
+
+    public:
+        explicit ConstIterator(const TreeNode* current_node = nullptr);
+        ConstIterator(const Iterator& iterator);
+
+        ConstIterator& operator++();
+        ConstIterator operator++(int);
+
+        const T& operator*() const;
+        const T* operator->() const;
+
+        const TreeNode* current_node() const;
 
     private:
-        TreeNode* m_current_node;
-        std::unordered_set<TreeNode*> m_viewed_nodes;
+        const TreeNode* m_current_node;
     };
 
+    class PostorderIterator : public std::iterator<std::forward_iterator_tag, T, size_t, const T*, const T&>
+    {
+        friend bool operator==(const PostorderIterator& left, const PostorderIterator& right)
+        {
+            return left.m_current_node == right.m_current_node;
+        }
+
+        friend bool operator!=(const PostorderIterator& left, const PostorderIterator& right)
+        {
+            return left.m_current_node != right.m_current_node;
+        }
+
+    public:
+        explicit PostorderIterator(const TreeNode* current_node = nullptr);
+
+        PostorderIterator& operator++();
+        PostorderIterator operator++(int);
+
+        const T& operator*() const;
+        const T* operator->() const;
+
+        const TreeNode* current_node() const;
+
+    private:
+        const TreeNode* m_current_node;
+    };
+
+    class BreadthFirstIterator : public std::iterator<std::forward_iterator_tag, T, size_t, const T*, const T&>
+    {
+        friend bool operator==(const BreadthFirstIterator& left, const BreadthFirstIterator& right)
+        {
+            return left.current_node() == right.current_node();
+        }
+
+        friend bool operator!=(const BreadthFirstIterator& left, const BreadthFirstIterator& right)
+        {
+            return left.current_node() != right.current_node();
+        }
+
+    public:
+        explicit BreadthFirstIterator(const TreeNode* current_node = nullptr);
+
+        BreadthFirstIterator& operator++();
+        BreadthFirstIterator operator++(int);
+
+        const T& operator*() const;
+        const T* operator->() const;
+
+        const TreeNode* current_node() const;
+
+    private:
+        std::deque<const TreeNode*> m_queue;  // Front is the current node
+    };
+
+    typedef std::vector<const TreeNode*> level_nodes_t;
+
+    // Iterates over the tree levels: all nodes of the same depth at once, in preorder
+    class LevelIterator : public std::iterator<std::forward_iterator_tag, level_nodes_t, size_t,
+                                               const level_nodes_t*, const level_nodes_t&>
+    {
+        friend bool operator==(const LevelIterator& left, const LevelIterator& right)
+        {
+            return left.m_level.empty() == right.m_level.empty()
+                    && (left.m_level.empty() || left.m_depth == right.m_depth);
+        }
+
+        friend bool operator!=(const LevelIterator& left, const LevelIterator& right)
+        {
+            return !(left == right);
+        }
+
+    public:
+        explicit LevelIterator(const TreeNode* root = nullptr);
+
+        LevelIterator& operator++();
+        LevelIterator operator++(int);
+
+        const level_nodes_t& operator*() const;
+        const level_nodes_t* operator->() const;
+
+        size_t depth() const;
+
+    private:
+        level_nodes_t m_level;
+        level_nodes_t m_next_level;     /*!< Buffer reused for the next level */
+        size_t m_depth;
+    };
+
+    template <typename TIterator>
+    class Range
+    {
+    public:
+        Range(TIterator begin, TIterator end);
+
+        TIterator begin() const;
+        TIterator end() const;
+
+    private:
+        TIterator m_begin;
+        TIterator m_end;
+    };
+
+    typedef Iterator iterator;
+    typedef ConstIterator const_iterator;
+
+    typedef std::function<size_t(const T&)> value_hasher_t;
+
 public:
-    // TODO: make parameters const references
-    static bool equal(DirectedRootedTree& left, DirectedRootedTree& right);
+    // Compares the values and the shapes of the trees.
+    // Different trees hashed by the same hasher are rejected by the root hashes in O(1):
+    // both by the default std::hash<T>, or by one hasher shared by a tree and its copies.
+    static bool equal(const DirectedRootedTree& left, const DirectedRootedTree& right);
+
+    // True when the hashers are known to give the same hashes: the same hasher or both the default std::hash<T>
+    static bool same_hashers(const std::shared_ptr<const value_hasher_t>& left,
+                             const std::shared_ptr<const value_hasher_t>& right);
 
 public:
     explicit DirectedRootedTree(const T& value);
     explicit DirectedRootedTree(T&& root_value = T());
 
+    // Copies are built in one preorder pass, all nodes are placed in a single slab.
+    // Structural hashes are copied, listeners are not.
+    DirectedRootedTree(const DirectedRootedTree& other);
+    DirectedRootedTree& operator=(const DirectedRootedTree& other);
+
+    // Moves never throw, so containers of trees move them instead of copying.
+    // A moved-from tree has no root and no nodes: it may only be assigned to or destroyed,
+    // add_child and reserve throw std::logic_error.
+    DirectedRootedTree(DirectedRootedTree&& other) noexcept;
+    DirectedRootedTree& operator=(DirectedRootedTree&& other) noexcept;
+
+    DirectedRootedTree clone() const;
+
+    ~DirectedRootedTree();
+
     const TreeNode* root() const;
     TreeNode* root();
 
     Iterator begin();
     Iterator end();
 
+    ConstIterator begin() const;
+    ConstIterator end() const;
+
+    ConstIterator cbegin() const;
+    ConstIterator cend() const;
+
+    Range<PostorderIterator> postorder() const;
+    Range<BreadthFirstIterator> breadth_first() const;
+    Range<LevelIterator> levels() const;
+
     TreeNode* add_child(TreeNode* parent, const T& value);
     TreeNode* add_child(TreeNode* parent, T&& value);
     void remove_node(TreeNode* node);
 
+    // Values changed through TreeNode::value() are not seen by the listeners and by the structural hashes
+    void set_value(TreeNode* node, const T& value);
+    void set_value(TreeNode* node, T&& value);
+
+    // Recomputes the structural hashes and sends tree_replaced to the listeners
+    // after values were changed in place through TreeNode::value()
+    void values_replaced();
+
+    // Removes all nodes of the range at once, every affected children list is rebuilt only once.
+    // Throws std::invalid_argument without changing anything if a node does not belong to the tree.
+    template <typename TNodeRange>
+    void remove_nodes(const TNodeRange& nodes);
+
     size_t size() const;
 
+    void reserve(size_t nodes_count);
+
+    // Listeners stay with the tree object and are not transferred by moving the tree
+    void add_listener(Listener* listener);
+    void remove_listener(Listener* listener);
+    bool has_listeners() const;
+
+    // Computes the structural hashes of all nodes, afterwards every edit updates them along the path to the root.
+    // The hasher is shared with the copies of the tree.
+    void enable_structural_hashing(value_hasher_t value_hasher = std::hash<T>());
+    void disable_structural_hashing();
+    bool structural_hashing_enabled() const;
+    std::shared_ptr<const value_hasher_t> structural_hasher() const;   // Empty while structural hashing is disabled
+
+    // Computes the depth, the subtree size and the height of all nodes, afterwards the edits update them.
+    // add_child costs the path to the root, remove_node the subtrees of the children of the node
+    // and the path to the root, remove_nodes recomputes all nodes. Heights are kept by counting
+    // the children of every height, so no siblings are scanned.
+    // The structural hashes and the node metrics are allocated aside from the nodes only while enabled.
+    void enable_node_metrics();
+    void disable_node_metrics();
+    bool node_metrics_enabled() const;
+
+private:
+    static TreeNode* next_preorder(const TreeNode* node);
+    static TreeNode* first_postorder(TreeNode* node);
+    static TreeNode* next_postorder(const TreeNode* node);
+
+    template <typename V>
+    node_ptr_t make_node(V&& value, TreeNode* parent);
+    template <typename V>
+    TreeNode* insert_child(TreeNode* parent, V&& value);
+    void destroy_nodes() noexcept;
+    void copy_nodes(const DirectedRootedTree& other);
+    void notify_tree_replaced() noexcept;
+
+    static std::unique_ptr< NodePool<TreeNode> > make_pool(size_t nodes_count);
+
+    template <typename V>
+    void assign_value(TreeNode* node, V&& value);
+
+    static size_t mix_hash(size_t hash);
+    size_t value_hash(const T& value) const;
+    size_t compute_hash(const TreeNode* node) const;
+    static size_t child_hash_term(size_t child_hash, size_t child_index);
+    void propagate_hash(TreeNode* node, size_t hash);
+    void rehash_paths(const std::unordered_set<TreeNode*>& nodes);
+    void compute_hashes();
+
+    void allocate_aggregates();
+    void release_aggregates();
+    void release_aggregates(TreeNode* node);
+
+    void compute_node_metrics();
+    void add_node_metrics(TreeNode* child);
+    void remove_node_metrics(TreeNode* parent, const TreeNode* removed,
+                             size_t first_moved_child, size_t moved_children_count);
+    static void update_heights(TreeNode* node);
+    static size_t children_height(const NodeAggregates& aggregates);
+    static void remove_child_height(NodeAggregates& aggregates, size_t height);
+
 private:
-    std::unique_ptr<TreeNode> m_root;
+    std::unique_ptr< NodePool<TreeNode> > m_pool;  // Must outlive all nodes
+    std::unique_ptr< NodePool<NodeAggregates> > m_aggregates_pool; // Empty while no aggregates are kept
+    node_ptr_t m_root;
     size_t m_size;
+    std::vector<Listener*> m_listeners;
+    std::shared_ptr<const value_hasher_t> m_value_hasher;  // Empty when structural hashing is disabled
+    bool m_node_metrics;
 };
 
 
 #include "TreeNodeImpl.h"
 #include "IteratorImpl.h"
+#include "TraversalIteratorsImpl.h"
 #include "DirectedRootedTreeimpl.h"
+#include "ConcurrentBuildImpl.h"
 
 
 #endif // DIRECTEDROOTEDTREE_H
@@ -13,11 +13,38 @@ CONFIG += staticlib
 SOURCES +=
 
 HEADERS += DirectedRootedTree.h \
+    NodePool.h \
+    CacheLineAligned.h \
     DirectedRootedTreeimpl.h \
     TreeNodeImpl.h \
+    ConcurrentBuildImpl.h \
     IteratorImpl.h \
+    TraversalIteratorsImpl.h \
     TreeAlgorithms.h \
-    TreeAlgorithmsImpl.h
+    TreeAlgorithmsImpl.h \
+    FlatDirectedRootedTree.h \
+    FlatDirectedRootedTreeImpl.h \
+    WorkStealingPool.h \
+    ParallelTreeAlgorithms.h \
+    ParallelTreeAlgorithmsImpl.h \
+    IncrementalSequencer.h \
+    IncrementalSequencerImpl.h \
+    DirectedAcyclicGraph.h \
+    DirectedAcyclicGraphImpl.h \
+    GraphAlgorithms.h \
+    GraphAlgorithmsImpl.h \
+    SequencingCache.h \
+    SequencingCacheImpl.h \
+    PersistentDirectedRootedTree.h \
+    PersistentDirectedRootedTreeImpl.h \
+    PersistentTreeAlgorithms.h \
+    PersistentTreeAlgorithmsImpl.h \
+    PublishedTree.h \
+    PublishedTreeImpl.h \
+    AncestorIndex.h \
+    AncestorIndexImpl.h \
+    ValueIndex.h \
+    ValueIndexImpl.h
 unix {
     target.path = /usr/lib
     INSTALLS += target
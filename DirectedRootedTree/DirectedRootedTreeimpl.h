@@ -5,33 +5,147 @@
 
 #include <iterator>
 #include <algorithm>
+#include <cstdint>
 #include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 
 template <typename T>
-bool DirectedRootedTree<T>::equal(DirectedRootedTree<T>& left,
-                                  DirectedRootedTree<T>& right)
+bool DirectedRootedTree<T>::equal(const DirectedRootedTree<T>& left,
+                                  const DirectedRootedTree<T>& right)
 {
     if (left.size() != right.size())
     {
         return false;
     }
-    return std::equal(left.begin(), left.end(), right.begin());
+    if (left.m_root && same_hashers(left.m_value_hasher, right.m_value_hasher)
+            && left.m_root->m_aggregates->hash != right.m_root->m_aggregates->hash)
+    {
+        return false;
+    }
+    // Equal children counts in preorder mean equal shapes
+    for (ConstIterator left_iter = left.cbegin(), right_iter = right.cbegin();
+         left_iter != left.cend();
+         ++left_iter, ++right_iter)
+    {
+        if (!(*left_iter == *right_iter)
+                || left_iter.current_node()->m_children.size() != right_iter.current_node()->m_children.size())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool DirectedRootedTree<T>::same_hashers(const std::shared_ptr<const value_hasher_t>& left,
+                                         const std::shared_ptr<const value_hasher_t>& right)
+{
+    // Hashers of the same type are not the same hasher when they hold a state or are function pointers,
+    // only the stateless default one is recognized by its type
+    if (!left || !right)
+    {
+        return false;
+    }
+    return left == right || (left->template target< std::hash<T> >() && right->template target< std::hash<T> >());
 }
 
 template <typename T>
 DirectedRootedTree<T>::DirectedRootedTree(const T& value)
-    : m_root(new TreeNode(value, nullptr)),
-      m_size(1)
+    : m_pool(new NodePool<TreeNode>()),
+      m_root(make_node(value, nullptr)),
+      m_size(1),
+      m_node_metrics(false)
 {
 
 }
 
 template <typename T>
 DirectedRootedTree<T>::DirectedRootedTree(T&& root_value)
-    : m_root(new TreeNode(std::move(root_value), nullptr)),
-      m_size(1)
+    : m_pool(new NodePool<TreeNode>()),
+      m_root(make_node(std::move(root_value), nullptr)),
+      m_size(1),
+      m_node_metrics(false)
+{
+
+}
+
+template <typename T>
+DirectedRootedTree<T>::DirectedRootedTree(const DirectedRootedTree& other)
+    : m_pool(make_pool(other.m_size)),
+      m_aggregates_pool(other.m_aggregates_pool ? new NodePool<NodeAggregates>() : nullptr),
+      m_root(other.m_root ? make_node(other.m_root->m_value, nullptr) : node_ptr_t()),
+      m_size(other.m_size),
+      m_value_hasher(other.m_value_hasher),
+      m_node_metrics(other.m_node_metrics)
+{
+    try
+    {
+        copy_nodes(other);
+    }
+    catch (...)
+    {
+        destroy_nodes();
+        throw;
+    }
+}
+
+template <typename T>
+DirectedRootedTree<T>& DirectedRootedTree<T>::operator=(const DirectedRootedTree& other)
 {
+    if (this != &other)
+    {
+        *this = DirectedRootedTree(other);
+    }
+    return *this;
+}
 
+template <typename T>
+DirectedRootedTree<T>::DirectedRootedTree(DirectedRootedTree&& other) noexcept
+    : m_pool(std::move(other.m_pool)),
+      m_aggregates_pool(std::move(other.m_aggregates_pool)),
+      m_root(std::move(other.m_root)),
+      m_size(other.m_size),
+      m_value_hasher(std::move(other.m_value_hasher)),
+      m_node_metrics(other.m_node_metrics)
+{
+    other.m_size = 0;
+    other.m_value_hasher = nullptr;
+    other.m_node_metrics = false;
+    other.notify_tree_replaced();
+}
+
+template <typename T>
+DirectedRootedTree<T>& DirectedRootedTree<T>::operator=(DirectedRootedTree&& other) noexcept
+{
+    if (this != &other)
+    {
+        destroy_nodes();
+        m_pool = std::move(other.m_pool);
+        m_aggregates_pool = std::move(other.m_aggregates_pool);
+        m_root = std::move(other.m_root);
+        m_size = other.m_size;
+        m_value_hasher = std::move(other.m_value_hasher);
+        m_node_metrics = other.m_node_metrics;
+        other.m_size = 0;
+        other.m_value_hasher = nullptr;
+        other.m_node_metrics = false;
+        notify_tree_replaced();
+        other.notify_tree_replaced();
+    }
+    return *this;
+}
+
+template <typename T>
+DirectedRootedTree<T> DirectedRootedTree<T>::clone() const
+{
+    return DirectedRootedTree(*this);
+}
+
+template <typename T>
+DirectedRootedTree<T>::~DirectedRootedTree()
+{
+    destroy_nodes();
 }
 
 template <typename T>
@@ -58,20 +172,62 @@ typename DirectedRootedTree<T>::Iterator DirectedRootedTree<T>::end()
     return Iterator(nullptr);
 }
 
+template <typename T>
+typename DirectedRootedTree<T>::ConstIterator DirectedRootedTree<T>::begin() const
+{
+    return ConstIterator(m_root.get());
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::ConstIterator DirectedRootedTree<T>::end() const
+{
+    return ConstIterator(nullptr);
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::ConstIterator DirectedRootedTree<T>::cbegin() const
+{
+    return begin();
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::ConstIterator DirectedRootedTree<T>::cend() const
+{
+    return end();
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::template Range<typename DirectedRootedTree<T>::PostorderIterator>
+DirectedRootedTree<T>::postorder() const
+{
+    return Range<PostorderIterator>(PostorderIterator(m_root ? first_postorder(m_root.get()) : nullptr),
+                                    PostorderIterator(nullptr));
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::template Range<typename DirectedRootedTree<T>::BreadthFirstIterator>
+DirectedRootedTree<T>::breadth_first() const
+{
+    return Range<BreadthFirstIterator>(BreadthFirstIterator(m_root.get()), BreadthFirstIterator(nullptr));
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::template Range<typename DirectedRootedTree<T>::LevelIterator>
+DirectedRootedTree<T>::levels() const
+{
+    return Range<LevelIterator>(LevelIterator(m_root.get()), LevelIterator(nullptr));
+}
+
 template <typename T>
 typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::add_child(TreeNode* parent, const T& value)
 {
-    TreeNode* child = parent->add_child(std::unique_ptr<TreeNode>(new TreeNode(value, parent)));
-    ++m_size;
-    return child;
+    return insert_child(parent, value);
 }
 
 template <typename T>
 typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::add_child(TreeNode* parent, T&& value)
 {
-    TreeNode* child = parent->add_child(std::unique_ptr<TreeNode>(new TreeNode(std::move(value), parent)));
-    ++m_size;
-    return child;
+    return insert_child(parent, std::move(value));
 }
 
 template <typename T>
@@ -82,35 +238,211 @@ void DirectedRootedTree<T>::remove_node(TreeNode* node)
         throw std::logic_error("Root node cannot be removed");
     }
     TreeNode* parent = node->m_parent;
-
-    typename node_children_t::iterator iter = std::find_if(parent->m_children.begin(),
-                                                           parent->m_children.end(),
-                                                           [node](const std::unique_ptr<TreeNode>& child) -> bool
-    {
-        return child.get() == node;
-    });
-    if (iter == parent->m_children.end())
+    node_children_t& siblings = parent->m_children;
+    const size_t index = node->m_child_index;
+    if (index >= siblings.size() || siblings[index].get() != node)
     {
         throw std::runtime_error("Inconsistent tree: node is not in the children list of it`s parent");
     }
-    std::unique_ptr<TreeNode> node_obj = std::move(*iter);  // Make node a scoped object
+    for (Listener* listener : m_listeners)
+    {
+        listener->node_removing(node);
+    }
+    node_ptr_t node_obj = std::move(siblings[index]);  // Make node a scoped object
 
-    for (std::unique_ptr<TreeNode>& child : node->m_children)
+    node_children_t& children = node->m_children;
+    for (node_ptr_t& child : children)
     {
         child->m_parent = parent;
     }
 
-    iter = parent->m_children.insert(iter,
-                                     std::make_move_iterator(node->m_children.begin()),
-                                     std::make_move_iterator(node->m_children.end()));
-    iter += node->m_children.size();
-    parent->m_children.erase(iter);
+    // Children take the place of the node: the tail of siblings is shifted at most once
+    // and is not touched at all when the node has exactly one child
+    if (children.empty())
+    {
+        siblings.erase(siblings.begin() + index);
+    }
+    else
+    {
+        siblings[index] = std::move(children.front());
+        siblings.insert(siblings.begin() + index + 1,
+                        std::make_move_iterator(children.begin() + 1),
+                        std::make_move_iterator(children.end()));
+    }
+
+    const size_t reindex_end = children.size() == 1 ? index + 1 : siblings.size();
+    for (size_t sibling_index = index; sibling_index != reindex_end; ++sibling_index)
+    {
+        siblings[sibling_index]->m_child_index = sibling_index;
+    }
 
     --m_size;
     if (m_size == 0)
     {
         throw std::runtime_error("Inconsistent tree: size is invalid");
     }
+    if (m_node_metrics)
+    {
+        remove_node_metrics(parent, node, index, children.size());
+    }
+    release_aggregates(node);
+    if (m_value_hasher)
+    {
+        propagate_hash(parent, compute_hash(parent));
+    }
+    for (Listener* listener : m_listeners)
+    {
+        listener->node_removed(parent, index, children.size());
+    }
+}
+
+template <typename T>
+template <typename TNodeRange>
+void DirectedRootedTree<T>::remove_nodes(const TNodeRange& nodes)
+{
+    std::unordered_set<const TreeNode*> removed_nodes(std::begin(nodes), std::end(nodes));
+    if (removed_nodes.empty())
+    {
+        return;
+    }
+    if (removed_nodes.count(m_root.get()))
+    {
+        throw std::logic_error("Root node cannot be removed");
+    }
+
+    // Nothing is changed until every node is known to be linked up to the root of this tree
+    std::unordered_set<const TreeNode*> linked_nodes;
+    linked_nodes.insert(m_root.get());
+    for (const TreeNode* node : removed_nodes)
+    {
+        for (; !linked_nodes.count(node); node = node->m_parent)
+        {
+            const TreeNode* parent = node->m_parent;
+            if (!parent
+                    || node->m_child_index >= parent->m_children.size()
+                    || parent->m_children[node->m_child_index].get() != node)
+            {
+                throw std::invalid_argument("Removed node does not belong to the tree");
+            }
+            linked_nodes.insert(node);
+        }
+    }
+
+    // Only the nearest remaining ancestors of the removed nodes get new children lists
+    std::unordered_set<TreeNode*> affected_parents;
+    for (const TreeNode* node : removed_nodes)
+    {
+        if (!removed_nodes.count(node->m_parent))
+        {
+            affected_parents.insert(node->m_parent);
+        }
+    }
+
+    for (Listener* listener : m_listeners)
+    {
+        for (const TreeNode* node : removed_nodes)
+        {
+            listener->node_removing(node);
+        }
+    }
+
+    // Runs of the spliced children in the new children lists, reported to the listeners
+    struct SplicedRun
+    {
+        TreeNode* parent;
+        size_t first_child;
+        size_t children_count;
+    };
+    std::vector<SplicedRun> spliced_runs;
+
+    std::vector<node_ptr_t> removed_objs;  // Destroyed when all lists are rebuilt
+    removed_objs.reserve(removed_nodes.size());
+    std::vector< std::pair<node_children_t*, size_t> > pending;
+    for (TreeNode* parent : affected_parents)
+    {
+        const size_t parent_runs_begin = spliced_runs.size();
+        node_children_t old_children;
+        old_children.swap(parent->m_children);
+        parent->m_children.reserve(old_children.size());
+
+        pending.emplace_back(&old_children, 0);
+        while (!pending.empty())
+        {
+            node_children_t& children = *pending.back().first;
+            if (pending.back().second == children.size())
+            {
+                pending.pop_back();
+                continue;
+            }
+            node_ptr_t& child = children[pending.back().second++];
+            if (removed_nodes.count(child.get()))
+            {
+                // Children of a removed node are spliced in its place
+                pending.emplace_back(&child->m_children, 0);
+                removed_objs.push_back(std::move(child));
+            }
+            else
+            {
+                const size_t child_index = parent->m_children.size();
+                if (pending.size() > 1)
+                {
+                    if (spliced_runs.size() == parent_runs_begin
+                            || spliced_runs.back().first_child + spliced_runs.back().children_count != child_index)
+                    {
+                        spliced_runs.push_back({ parent, child_index, 0 });
+                    }
+                    ++spliced_runs.back().children_count;
+                }
+                child->m_parent = parent;
+                child->m_child_index = child_index;
+                parent->m_children.push_back(std::move(child));
+            }
+        }
+        if (spliced_runs.size() == parent_runs_begin)
+        {
+            spliced_runs.push_back({ parent, 0, 0 });
+        }
+    }
+
+    m_size -= removed_objs.size();
+    for (node_ptr_t& removed_obj : removed_objs)
+    {
+        release_aggregates(removed_obj.get());
+    }
+    if (m_node_metrics)
+    {
+        compute_node_metrics();
+    }
+    if (m_value_hasher)
+    {
+        rehash_paths(affected_parents);
+    }
+    for (Listener* listener : m_listeners)
+    {
+        for (const SplicedRun& run : spliced_runs)
+        {
+            listener->node_removed(run.parent, run.first_child, run.children_count);
+        }
+    }
+}
+
+template <typename T>
+void DirectedRootedTree<T>::set_value(TreeNode* node, const T& value)
+{
+    assign_value(node, value);
+}
+
+template <typename T>
+void DirectedRootedTree<T>::set_value(TreeNode* node, T&& value)
+{
+    assign_value(node, std::move(value));
+}
+
+template <typename T>
+void DirectedRootedTree<T>::values_replaced()
+{
+    compute_hashes();
+    notify_tree_replaced();
 }
 
 template <typename T>
@@ -119,4 +451,582 @@ size_t DirectedRootedTree<T>::size() const
     return m_size;
 }
 
+template <typename T>
+void DirectedRootedTree<T>::reserve(size_t nodes_count)
+{
+    if (!m_pool)
+    {
+        throw std::logic_error("Tree was moved from");
+    }
+    if (nodes_count > m_size)
+    {
+        m_pool->reserve(nodes_count - m_size);
+    }
+}
+
+template <typename T>
+void DirectedRootedTree<T>::add_listener(Listener* listener)
+{
+    m_listeners.push_back(listener);
+}
+
+template <typename T>
+void DirectedRootedTree<T>::remove_listener(Listener* listener)
+{
+    m_listeners.erase(std::remove(m_listeners.begin(), m_listeners.end(), listener), m_listeners.end());
+}
+
+template <typename T>
+bool DirectedRootedTree<T>::has_listeners() const
+{
+    return !m_listeners.empty();
+}
+
+template <typename T>
+void DirectedRootedTree<T>::enable_structural_hashing(value_hasher_t value_hasher)
+{
+    if (!value_hasher)
+    {
+        disable_structural_hashing();
+        return;
+    }
+    allocate_aggregates();
+    m_value_hasher = std::make_shared<const value_hasher_t>(std::move(value_hasher));
+    compute_hashes();
+}
+
+template <typename T>
+void DirectedRootedTree<T>::disable_structural_hashing()
+{
+    m_value_hasher = nullptr;
+    if (!m_node_metrics)
+    {
+        release_aggregates();
+    }
+}
+
+template <typename T>
+bool DirectedRootedTree<T>::structural_hashing_enabled() const
+{
+    return static_cast<bool>(m_value_hasher);
+}
+
+template <typename T>
+std::shared_ptr<const typename DirectedRootedTree<T>::value_hasher_t> DirectedRootedTree<T>::structural_hasher() const
+{
+    return m_value_hasher;
+}
+
+template <typename T>
+void DirectedRootedTree<T>::enable_node_metrics()
+{
+    allocate_aggregates();
+    m_node_metrics = true;
+    compute_node_metrics();
+}
+
+template <typename T>
+void DirectedRootedTree<T>::disable_node_metrics()
+{
+    m_node_metrics = false;
+    if (!m_value_hasher)
+    {
+        release_aggregates();
+        return;
+    }
+    // Only the hashes are still kept
+    for (Iterator iter = begin(); iter != end(); ++iter)
+    {
+        iter.current_node()->m_aggregates->children_heights.clear();
+    }
+}
+
+template <typename T>
+bool DirectedRootedTree<T>::node_metrics_enabled() const
+{
+    return m_node_metrics;
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::next_preorder(const TreeNode* node)
+{
+    if (!node->m_children.empty())
+    {
+        return node->m_children.front().get();
+    }
+    // Go up until a node with the next sibling is found
+    while (node->m_parent)
+    {
+        const node_children_t& siblings = node->m_parent->m_children;
+        if (node->m_child_index + 1 < siblings.size())
+        {
+            return siblings[node->m_child_index + 1].get();
+        }
+        node = node->m_parent;
+    }
+    return nullptr;
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::first_postorder(TreeNode* node)
+{
+    while (!node->m_children.empty())
+    {
+        node = node->m_children.front().get();
+    }
+    return node;
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::next_postorder(const TreeNode* node)
+{
+    TreeNode* parent = node->m_parent;
+    if (!parent)
+    {
+        return nullptr;
+    }
+    if (node->m_child_index + 1 < parent->m_children.size())
+    {
+        return first_postorder(parent->m_children[node->m_child_index + 1].get());
+    }
+    return parent;
+}
+
+template <typename T>
+template <typename V>
+typename DirectedRootedTree<T>::node_ptr_t DirectedRootedTree<T>::make_node(V&& value, TreeNode* parent)
+{
+    return node_ptr_t(m_pool->create(std::forward<V>(value), parent), NodeDeleter(m_pool.get()));
+}
+
+template <typename T>
+template <typename V>
+typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::insert_child(TreeNode* parent, V&& value)
+{
+    if (!m_pool)
+    {
+        throw std::logic_error("Tree was moved from");
+    }
+    node_ptr_t node = make_node(std::forward<V>(value), parent);
+    if (m_aggregates_pool)
+    {
+        node->m_aggregates = m_aggregates_pool->create();
+    }
+    TreeNode* child = nullptr;
+    try
+    {
+        child = parent->add_child(std::move(node));
+    }
+    catch (...)
+    {
+        release_aggregates(node.get());
+        throw;
+    }
+
+    ++m_size;
+    if (m_node_metrics)
+    {
+        add_node_metrics(child);
+    }
+    if (m_value_hasher)
+    {
+        child->m_aggregates->hash = value_hash(child->m_value);
+        propagate_hash(parent, parent->m_aggregates->hash
+                       + child_hash_term(child->m_aggregates->hash, child->m_child_index));
+    }
+    for (Listener* listener : m_listeners)
+    {
+        listener->node_added(child);
+    }
+    return child;
+}
+
+template <typename T>
+void DirectedRootedTree<T>::destroy_nodes() noexcept
+{
+    if (!m_root)
+    {
+        return;
+    }
+    // Nodes are destroyed in postorder by following the parent links, so nothing is allocated,
+    // and without returning their slots to the free list: the slabs are released by the pool all at once
+    TreeNode* node = first_postorder(m_root.release());
+    while (node)
+    {
+        TreeNode* next = next_postorder(node);
+        for (node_ptr_t& child : node->m_children)
+        {
+            child.release();    // Already destroyed
+        }
+        if (node->m_aggregates)
+        {
+            m_aggregates_pool->destroy_in_place(node->m_aggregates);
+        }
+        m_pool->destroy_in_place(node);
+        node = next;
+    }
+    m_size = 0;
+}
+
+template <typename T>
+void DirectedRootedTree<T>::copy_nodes(const DirectedRootedTree& other)
+{
+    if (!m_root)
+    {
+        return;
+    }
+    // Nodes are created in preorder, so they are laid out in the slab in preorder as well
+    if (m_aggregates_pool)
+    {
+        m_aggregates_pool->reserve(other.m_size);
+        m_root->m_aggregates = m_aggregates_pool->create(*other.m_root->m_aggregates);
+    }
+    m_root->m_children.reserve(other.m_root->m_children.size());
+    std::vector< std::pair<const TreeNode*, TreeNode*> > pending;  // Source node and parent of its copy
+    for (auto iter = other.m_root->m_children.rbegin(); iter != other.m_root->m_children.rend(); ++iter)
+    {
+        pending.emplace_back(iter->get(), m_root.get());
+    }
+    while (!pending.empty())
+    {
+        const TreeNode* source = pending.back().first;
+        TreeNode* parent = pending.back().second;
+        pending.pop_back();
+
+        TreeNode* node = parent->add_child(make_node(source->m_value, parent));
+        if (m_aggregates_pool)
+        {
+            node->m_aggregates = m_aggregates_pool->create(*source->m_aggregates);
+        }
+        node->m_children.reserve(source->m_children.size());
+        for (auto iter = source->m_children.rbegin(); iter != source->m_children.rend(); ++iter)
+        {
+            pending.emplace_back(iter->get(), node);
+        }
+    }
+}
+
+template <typename T>
+std::unique_ptr< NodePool<typename DirectedRootedTree<T>::TreeNode> > DirectedRootedTree<T>::make_pool(size_t nodes_count)
+{
+    std::unique_ptr< NodePool<TreeNode> > pool(new NodePool<TreeNode>());
+    pool->reserve(nodes_count);
+    return pool;
+}
+
+template <typename T>
+void DirectedRootedTree<T>::notify_tree_replaced() noexcept
+{
+    for (Listener* listener : m_listeners)
+    {
+        listener->tree_replaced();
+    }
+}
+
+template <typename T>
+template <typename V>
+void DirectedRootedTree<T>::assign_value(TreeNode* node, V&& value)
+{
+    for (Listener* listener : m_listeners)
+    {
+        listener->value_changing(node);
+    }
+    const size_t old_value_hash = m_value_hasher ? value_hash(node->m_value) : 0;
+    node->m_value = std::forward<V>(value);
+    if (m_value_hasher)
+    {
+        propagate_hash(node, node->m_aggregates->hash - old_value_hash + value_hash(node->m_value));
+    }
+    for (Listener* listener : m_listeners)
+    {
+        listener->value_changed(node);
+    }
+}
+
+// The hash of a node is h(value) + sum of h(child_i) * P^(i + 1), where h is mixed by the splitmix64 finalizer.
+// A changed child hash or an appended child changes the sum by one term.
+template <typename T>
+size_t DirectedRootedTree<T>::mix_hash(size_t hash)
+{
+    uint64_t mixed = hash;
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<size_t>(mixed ^ (mixed >> 31));
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::value_hash(const T& value) const
+{
+    return mix_hash((*m_value_hasher)(value));
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::compute_hash(const TreeNode* node) const
+{
+    size_t hash = value_hash(node->m_value);
+    for (size_t i = 0; i != node->m_children.size(); ++i)
+    {
+        hash += child_hash_term(node->m_children[i]->m_aggregates->hash, i);
+    }
+    return hash;
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::child_hash_term(size_t child_hash, size_t child_index)
+{
+    uint64_t hash = mix_hash(child_hash);
+
+    // Arithmetic is modulo 2^64, the multiplier is odd
+    uint64_t factor = 0x9e3779b97f4a7c15ULL;
+    for (uint64_t exponent = child_index + 1; exponent != 0; exponent >>= 1)
+    {
+        if (exponent & 1)
+        {
+            hash *= factor;
+        }
+        factor *= factor;
+    }
+    return static_cast<size_t>(hash);
+}
+
+template <typename T>
+void DirectedRootedTree<T>::propagate_hash(TreeNode* node, size_t hash)
+{
+    while (true)
+    {
+        const size_t old_hash = node->m_aggregates->hash;
+        node->m_aggregates->hash = hash;
+        TreeNode* parent = node->m_parent;
+        if (!parent || old_hash == hash)
+        {
+            return;
+        }
+        hash = parent->m_aggregates->hash
+                - child_hash_term(old_hash, node->m_child_index)
+                + child_hash_term(hash, node->m_child_index);
+        node = parent;
+    }
+}
+
+template <typename T>
+void DirectedRootedTree<T>::rehash_paths(const std::unordered_set<TreeNode*>& nodes)
+{
+    // Nodes on the paths to the root are recomputed after all of their stale children
+    std::unordered_map<TreeNode*, size_t> stale_children_counts;
+    for (TreeNode* node : nodes)
+    {
+        if (!stale_children_counts.emplace(node, 0).second)
+        {
+            continue;
+        }
+        for (TreeNode* parent = node->m_parent; parent; parent = parent->m_parent)
+        {
+            std::pair<typename std::unordered_map<TreeNode*, size_t>::iterator, bool> inserted =
+                    stale_children_counts.emplace(parent, 0);
+            ++inserted.first->second;
+            if (!inserted.second)
+            {
+                break;
+            }
+        }
+    }
+
+    std::vector<TreeNode*> ready;
+    for (const std::pair<TreeNode* const, size_t>& stale_node : stale_children_counts)
+    {
+        if (stale_node.second == 0)
+        {
+            ready.push_back(stale_node.first);
+        }
+    }
+    while (!ready.empty())
+    {
+        TreeNode* node = ready.back();
+        ready.pop_back();
+        node->m_aggregates->hash = compute_hash(node);
+        if (node->m_parent && --stale_children_counts[node->m_parent] == 0)
+        {
+            ready.push_back(node->m_parent);
+        }
+    }
+}
+
+template <typename T>
+void DirectedRootedTree<T>::compute_hashes()
+{
+    if (!m_value_hasher || !m_root)
+    {
+        return;
+    }
+    for (PostorderIterator iter = postorder().begin(); iter != postorder().end(); ++iter)
+    {
+        TreeNode* node = const_cast<TreeNode*>(iter.current_node());
+        node->m_aggregates->hash = compute_hash(node);
+    }
+}
+
+template <typename T>
+void DirectedRootedTree<T>::allocate_aggregates()
+{
+    if (!m_aggregates_pool)
+    {
+        m_aggregates_pool.reset(new NodePool<NodeAggregates>());
+        m_aggregates_pool->reserve(m_size);
+    }
+    // Nodes added by a concurrent build have no aggregates yet
+    for (Iterator iter = begin(); iter != end(); ++iter)
+    {
+        TreeNode* node = iter.current_node();
+        if (!node->m_aggregates)
+        {
+            node->m_aggregates = m_aggregates_pool->create();
+        }
+    }
+}
+
+template <typename T>
+void DirectedRootedTree<T>::release_aggregates()
+{
+    if (!m_aggregates_pool)
+    {
+        return;
+    }
+    for (Iterator iter = begin(); iter != end(); ++iter)
+    {
+        TreeNode* node = iter.current_node();
+        if (node->m_aggregates)
+        {
+            m_aggregates_pool->destroy_in_place(node->m_aggregates);
+            node->m_aggregates = nullptr;
+        }
+    }
+    m_aggregates_pool.reset();
+}
+
+template <typename T>
+void DirectedRootedTree<T>::release_aggregates(TreeNode* node)
+{
+    if (node->m_aggregates)
+    {
+        m_aggregates_pool->destroy(node->m_aggregates);
+        node->m_aggregates = nullptr;
+    }
+}
+
+template <typename T>
+void DirectedRootedTree<T>::compute_node_metrics()
+{
+    if (!m_root)
+    {
+        return;
+    }
+    for (Iterator iter = begin(); iter != end(); ++iter)
+    {
+        TreeNode* node = iter.current_node();
+        node->m_aggregates->depth = node->m_parent ? node->m_parent->m_aggregates->depth + 1 : 0;
+    }
+    for (PostorderIterator iter = postorder().begin(); iter != postorder().end(); ++iter)
+    {
+        NodeAggregates& aggregates = *iter.current_node()->m_aggregates;
+        aggregates.subtree_size = 1;
+        aggregates.children_heights.clear();
+        for (const node_ptr_t& child : iter.current_node()->m_children)
+        {
+            aggregates.subtree_size += child->m_aggregates->subtree_size;
+            ++aggregates.children_heights[child->m_aggregates->height];
+        }
+        aggregates.height = children_height(aggregates);
+    }
+}
+
+template <typename T>
+void DirectedRootedTree<T>::add_node_metrics(TreeNode* child)
+{
+    NodeAggregates& aggregates = *child->m_aggregates;
+    aggregates.depth = child->m_parent->m_aggregates->depth + 1;
+    aggregates.subtree_size = 1;
+    aggregates.height = 0;
+    aggregates.children_heights.clear();
+
+    ++child->m_parent->m_aggregates->children_heights[0];
+    for (TreeNode* ancestor = child->m_parent; ancestor; ancestor = ancestor->m_parent)
+    {
+        ++ancestor->m_aggregates->subtree_size;
+    }
+    update_heights(child->m_parent);
+}
+
+template <typename T>
+void DirectedRootedTree<T>::remove_node_metrics(TreeNode* parent, const TreeNode* removed,
+                                                size_t first_moved_child, size_t moved_children_count)
+{
+    // Subtrees of the moved children are one level higher now
+    NodeAggregates& parent_aggregates = *parent->m_aggregates;
+    remove_child_height(parent_aggregates, removed->m_aggregates->height);
+    std::vector<TreeNode*> pending;
+    for (size_t i = first_moved_child; i != first_moved_child + moved_children_count; ++i)
+    {
+        ++parent_aggregates.children_heights[parent->m_children[i]->m_aggregates->height];
+        pending.push_back(parent->m_children[i].get());
+    }
+    while (!pending.empty())
+    {
+        TreeNode* node = pending.back();
+        pending.pop_back();
+        --node->m_aggregates->depth;
+        for (const node_ptr_t& child : node->m_children)
+        {
+            pending.push_back(child.get());
+        }
+    }
+
+    for (TreeNode* ancestor = parent; ancestor; ancestor = ancestor->m_parent)
+    {
+        --ancestor->m_aggregates->subtree_size;
+    }
+    update_heights(parent);
+}
+
+template <typename T>
+void DirectedRootedTree<T>::update_heights(TreeNode* node)
+{
+    // A changed height moves one count in the parent, up to the first ancestor which keeps its height
+    for (; node; node = node->m_parent)
+    {
+        NodeAggregates& aggregates = *node->m_aggregates;
+        const size_t height = children_height(aggregates);
+        if (height == aggregates.height)
+        {
+            return;
+        }
+        if (node->m_parent)
+        {
+            NodeAggregates& parent_aggregates = *node->m_parent->m_aggregates;
+            remove_child_height(parent_aggregates, aggregates.height);
+            ++parent_aggregates.children_heights[height];
+        }
+        aggregates.height = height;
+    }
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::children_height(const NodeAggregates& aggregates)
+{
+    return aggregates.children_heights.empty() ? 0 : aggregates.children_heights.rbegin()->first + 1;
+}
+
+template <typename T>
+void DirectedRootedTree<T>::remove_child_height(NodeAggregates& aggregates, size_t height)
+{
+    std::map<size_t, size_t>::iterator iter = aggregates.children_heights.find(height);
+    if (iter == aggregates.children_heights.end())
+    {
+        throw std::runtime_error("Inconsistent tree: child height is not counted");
+    }
+    if (--iter->second == 0)
+    {
+        aggregates.children_heights.erase(iter);
+    }
+}
+
 #endif // DIRECTEDROOTEDTREEIMPL_H
@@ -0,0 +1,100 @@
+#ifndef FLATDIRECTEDROOTEDTREE_H
+#define FLATDIRECTEDROOTEDTREE_H
+
+#include <iterator>
+#include <vector>
+#include <limits>
+
+#include "DirectedRootedTree.h"
+
+// Index-based counterpart of DirectedRootedTree.
+// Nodes are identified by indices, links and values are kept in separate contiguous arrays.
+// Trees converted from DirectedRootedTree or compacted are laid out in preorder,
+// so that preorder traversal is a linear walk over the arrays.
+template <typename T>
+class FlatDirectedRootedTree
+{
+public:
+    typedef size_t node_index_t;
+
+    static const node_index_t invalid_index = std::numeric_limits<node_index_t>::max();
+
+    class Iterator : public std::iterator<std::forward_iterator_tag, T, size_t, T*, T&>
+    {
+        friend bool operator==(const Iterator& left, const Iterator& right)
+        {
+            return left.m_current_node == right.m_current_node;
+        }
+
+        friend bool operator!=(const Iterator& left, const Iterator& right)
+        {
+            return left.m_current_node != right.m_current_node;
+        }
+
+    public:
+        explicit Iterator(FlatDirectedRootedTree* tree = nullptr, node_index_t current_node = invalid_index);
+
+        Iterator& operator++();
+        Iterator operator++(int);
+
+        T& operator*();
+        T* operator->();
+
+        node_index_t current_node() const;
+
+    private:
+        FlatDirectedRootedTree* m_tree;
+        node_index_t m_current_node;
+    };
+
+public:
+    explicit FlatDirectedRootedTree(const T& value);
+    explicit FlatDirectedRootedTree(T&& root_value = T());
+    explicit FlatDirectedRootedTree(const DirectedRootedTree<T>& tree);
+
+    DirectedRootedTree<T> to_tree() const;
+
+    node_index_t root() const;
+
+    const T& value(node_index_t node) const;
+    T& value(node_index_t node);
+
+    node_index_t parent(node_index_t node) const;
+    node_index_t first_child(node_index_t node) const;
+    node_index_t next_sibling(node_index_t node) const;
+
+    Iterator begin();
+    Iterator end();
+
+    node_index_t add_child(node_index_t parent, const T& value);
+    node_index_t add_child(node_index_t parent, T&& value);
+    void remove_node(node_index_t node);
+
+    size_t size() const;
+
+    void reserve(size_t nodes_count);
+
+    // Lays the nodes out in preorder and drops the slots of removed nodes.
+    // Invalidates all node indices.
+    void compact();
+
+private:
+    template <typename V>
+    node_index_t allocate_node(node_index_t parent, V&& value);
+    node_index_t next_preorder(node_index_t node) const;
+    void link_child(node_index_t parent, node_index_t child);
+
+private:
+    std::vector<T> m_values;
+    std::vector<node_index_t> m_parents;
+    std::vector<node_index_t> m_first_children;
+    std::vector<node_index_t> m_last_children;
+    std::vector<node_index_t> m_next_siblings;
+    std::vector<node_index_t> m_prev_siblings;
+    std::vector<node_index_t> m_free_nodes;
+    size_t m_size;
+};
+
+#include "FlatDirectedRootedTreeImpl.h"
+
+#endif // FLATDIRECTEDROOTEDTREE_H
@@ -0,0 +1,356 @@
+#ifndef FLATDIRECTEDROOTEDTREEIMPL_H
+#define FLATDIRECTEDROOTEDTREEIMPL_H
+
+#include "FlatDirectedRootedTree.h"
+
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+template <typename T>
+const typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::invalid_index;
+
+template <typename T>
+FlatDirectedRootedTree<T>::Iterator::Iterator(FlatDirectedRootedTree* tree, node_index_t current_node)
+    : m_tree(tree),
+      m_current_node(current_node)
+{
+
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::Iterator& FlatDirectedRootedTree<T>::Iterator::operator++()
+{
+    if (m_current_node == invalid_index)
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    m_current_node = m_tree->next_preorder(m_current_node);
+    return *this;
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::Iterator FlatDirectedRootedTree<T>::Iterator::operator++(int)
+{
+    Iterator temp(*this);
+    operator++();
+    return temp;
+}
+
+template <typename T>
+T& FlatDirectedRootedTree<T>::Iterator::operator*()
+{
+    if (m_current_node == invalid_index)
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    return m_tree->m_values[m_current_node];
+}
+
+template <typename T>
+T* FlatDirectedRootedTree<T>::Iterator::operator->()
+{
+    return &operator*();
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::Iterator::current_node() const
+{
+    return m_current_node;
+}
+
+template <typename T>
+FlatDirectedRootedTree<T>::FlatDirectedRootedTree(const T& value)
+    : m_values(1, value),
+      m_parents(1, invalid_index),
+      m_first_children(1, invalid_index),
+      m_last_children(1, invalid_index),
+      m_next_siblings(1, invalid_index),
+      m_prev_siblings(1, invalid_index),
+      m_size(1)
+{
+
+}
+
+template <typename T>
+FlatDirectedRootedTree<T>::FlatDirectedRootedTree(T&& root_value)
+    : m_parents(1, invalid_index),
+      m_first_children(1, invalid_index),
+      m_last_children(1, invalid_index),
+      m_next_siblings(1, invalid_index),
+      m_prev_siblings(1, invalid_index),
+      m_size(1)
+{
+    m_values.push_back(std::move(root_value));
+}
+
+template <typename T>
+FlatDirectedRootedTree<T>::FlatDirectedRootedTree(const DirectedRootedTree<T>& tree)
+    : FlatDirectedRootedTree(tree.root()->value())
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    reserve(tree.size());
+
+    std::vector< std::pair<const TreeNode*, node_index_t> > pending;
+    const typename DirectedRootedTree<T>::node_children_t& root_children = tree.root()->children();
+    for (auto iter = root_children.rbegin(); iter != root_children.rend(); ++iter)
+    {
+        pending.emplace_back(iter->get(), root());
+    }
+    while (!pending.empty())
+    {
+        const TreeNode* node = pending.back().first;
+        node_index_t index = add_child(pending.back().second, node->value());
+        pending.pop_back();
+
+        const typename DirectedRootedTree<T>::node_children_t& children = node->children();
+        for (auto iter = children.rbegin(); iter != children.rend(); ++iter)
+        {
+            pending.emplace_back(iter->get(), index);
+        }
+    }
+}
+
+template <typename T>
+DirectedRootedTree<T> FlatDirectedRootedTree<T>::to_tree() const
+{
+    DirectedRootedTree<T> tree(m_values[root()]);
+    tree.reserve(m_size);
+
+    std::vector<typename DirectedRootedTree<T>::TreeNode*> nodes(m_values.size(), nullptr);
+    nodes[root()] = tree.root();
+    for (node_index_t node = next_preorder(root()); node != invalid_index; node = next_preorder(node))
+    {
+        nodes[node] = tree.add_child(nodes[m_parents[node]], m_values[node]);
+    }
+    return tree;
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::root() const
+{
+    return 0;
+}
+
+template <typename T>
+const T& FlatDirectedRootedTree<T>::value(node_index_t node) const
+{
+    return m_values[node];
+}
+
+template <typename T>
+T& FlatDirectedRootedTree<T>::value(node_index_t node)
+{
+    return m_values[node];
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::parent(node_index_t node) const
+{
+    return m_parents[node];
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::first_child(node_index_t node) const
+{
+    return m_first_children[node];
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::next_sibling(node_index_t node) const
+{
+    return m_next_siblings[node];
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::Iterator FlatDirectedRootedTree<T>::begin()
+{
+    return Iterator(this, root());
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::Iterator FlatDirectedRootedTree<T>::end()
+{
+    return Iterator(this, invalid_index);
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::add_child(node_index_t parent, const T& value)
+{
+    return allocate_node(parent, value);
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::add_child(node_index_t parent, T&& value)
+{
+    return allocate_node(parent, std::move(value));
+}
+
+template <typename T>
+void FlatDirectedRootedTree<T>::remove_node(node_index_t node)
+{
+    if (node == root())
+    {
+        throw std::logic_error("Root node cannot be removed");
+    }
+    if (m_parents[node] == invalid_index)
+    {
+        throw std::runtime_error("Inconsistent tree: node is already removed");
+    }
+    node_index_t parent = m_parents[node];
+    node_index_t prev = m_prev_siblings[node];
+    node_index_t next = m_next_siblings[node];
+    node_index_t first = m_first_children[node];
+    node_index_t last = m_last_children[node];
+
+    for (node_index_t child = first; child != invalid_index; child = m_next_siblings[child])
+    {
+        m_parents[child] = parent;
+    }
+
+    // Children take the place of the node in the list of its siblings
+    node_index_t head = next;
+    node_index_t tail = prev;
+    if (first != invalid_index)
+    {
+        m_prev_siblings[first] = prev;
+        m_next_siblings[last] = next;
+        head = first;
+        tail = last;
+    }
+    if (prev == invalid_index)
+    {
+        m_first_children[parent] = head;
+    }
+    else
+    {
+        m_next_siblings[prev] = head;
+    }
+    if (next == invalid_index)
+    {
+        m_last_children[parent] = tail;
+    }
+    else
+    {
+        m_prev_siblings[next] = tail;
+    }
+
+    m_values[node] = T();
+    m_parents[node] = invalid_index;
+    m_free_nodes.push_back(node);
+    --m_size;
+}
+
+template <typename T>
+size_t FlatDirectedRootedTree<T>::size() const
+{
+    return m_size;
+}
+
+template <typename T>
+void FlatDirectedRootedTree<T>::reserve(size_t nodes_count)
+{
+    m_values.reserve(nodes_count);
+    m_parents.reserve(nodes_count);
+    m_first_children.reserve(nodes_count);
+    m_last_children.reserve(nodes_count);
+    m_next_siblings.reserve(nodes_count);
+    m_prev_siblings.reserve(nodes_count);
+}
+
+template <typename T>
+void FlatDirectedRootedTree<T>::compact()
+{
+    FlatDirectedRootedTree compacted(std::move(m_values[root()]));
+    compacted.reserve(m_size);
+
+    std::vector<node_index_t> new_indexes(m_values.size(), invalid_index);
+    new_indexes[root()] = compacted.root();
+    for (node_index_t node = next_preorder(root()); node != invalid_index; node = next_preorder(node))
+    {
+        new_indexes[node] = compacted.add_child(new_indexes[m_parents[node]], std::move(m_values[node]));
+    }
+    *this = std::move(compacted);
+}
+
+template <typename T>
+template <typename V>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::allocate_node(node_index_t parent, V&& value)
+{
+    // The value and the arrays are in place before the node is linked, a throwing copy or growth
+    // leaves the tree unchanged
+    node_index_t node;
+    if (m_free_nodes.empty())
+    {
+        node = m_values.size();
+        m_values.push_back(std::forward<V>(value));
+        try
+        {
+            m_parents.push_back(invalid_index);
+            m_first_children.push_back(invalid_index);
+            m_last_children.push_back(invalid_index);
+            m_next_siblings.push_back(invalid_index);
+            m_prev_siblings.push_back(invalid_index);
+        }
+        catch (...)
+        {
+            for (std::vector<node_index_t>* links : { &m_parents, &m_first_children, &m_last_children,
+                                                      &m_next_siblings, &m_prev_siblings })
+            {
+                links->resize(node);
+            }
+            m_values.pop_back();
+            throw;
+        }
+    }
+    else
+    {
+        node = m_free_nodes.back();
+        m_values[node] = std::forward<V>(value);
+        m_free_nodes.pop_back();
+        m_first_children[node] = invalid_index;
+        m_last_children[node] = invalid_index;
+    }
+    link_child(parent, node);
+    ++m_size;
+    return node;
+}
+
+template <typename T>
+typename FlatDirectedRootedTree<T>::node_index_t FlatDirectedRootedTree<T>::next_preorder(node_index_t node) const
+{
+    if (m_first_children[node] != invalid_index)
+    {
+        return m_first_children[node];
+    }
+    while (node != invalid_index)
+    {
+        if (m_next_siblings[node] != invalid_index)
+        {
+            return m_next_siblings[node];
+        }
+        node = m_parents[node];
+    }
+    return invalid_index;
+}
+
+template <typename T>
+void FlatDirectedRootedTree<T>::link_child(node_index_t parent, node_index_t child)
+{
+    node_index_t prev = m_last_children[parent];
+    m_parents[child] = parent;
+    m_prev_siblings[child] = prev;
+    m_next_siblings[child] = invalid_index;
+    if (prev == invalid_index)
+    {
+        m_first_children[parent] = child;
+    }
+    else
+    {
+        m_next_siblings[prev] = child;
+    }
+    m_last_children[parent] = child;
+}
+
+#endif // FLATDIRECTEDROOTEDTREEIMPL_H
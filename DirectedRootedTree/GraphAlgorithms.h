@@ -0,0 +1,28 @@
+#ifndef GRAPHALGORITHMS_H
+#define GRAPHALGORITHMS_H
+
+#include "DirectedAcyclicGraph.h"
+#include "TreeAlgorithms.h"
+
+namespace tree_algorithms
+{
+
+// Nodes ordered so that every edge goes forward, by Kahn's algorithm
+template <typename T>
+std::vector<typename DirectedAcyclicGraph<T>::node_index_t> topological_order(const DirectedAcyclicGraph<T>& graph);
+
+// Groups the nodes by the longest path from a node without predecessors.
+// For a graph converted from a tree the first column holds the root, the rest is the tree's lower sequencing.
+template <typename T>
+parallel_sequencing_t<T> lower_parallel_sequencing(const DirectedAcyclicGraph<T>& graph);
+
+// Groups the nodes by the longest path to a node without successors.
+// For a graph converted from a tree the last column holds the root, the rest is the tree's upper sequencing.
+template <typename T>
+parallel_sequencing_t<T> upper_parallel_sequencing(const DirectedAcyclicGraph<T>& graph);
+
+}
+
+#include "GraphAlgorithmsImpl.h"
+
+#endif // GRAPHALGORITHMS_H
@@ -0,0 +1,124 @@
+#ifndef GRAPHALGORITHMSIMPL_H
+#define GRAPHALGORITHMSIMPL_H
+
+#include "GraphAlgorithms.h"
+
+#include <algorithm>
+
+namespace tree_algorithms
+{
+
+namespace detail
+{
+
+// Length of the longest path to every node from the nodes without predecessors,
+// or from the nodes without successors when the edges are reversed.
+// Nodes are visited by Kahn's algorithm in O(V + E).
+template <typename T>
+std::vector<size_t> graph_levels(const DirectedAcyclicGraph<T>& graph, bool reversed, size_t& levels_count)
+{
+    typedef typename DirectedAcyclicGraph<T>::node_index_t node_index_t;
+
+    std::vector<size_t> levels(graph.size(), 0);
+    std::vector<size_t> in_degrees(graph.size());
+    std::vector<node_index_t> ready;
+    for (node_index_t node = 0; node != graph.size(); ++node)
+    {
+        in_degrees[node] = reversed ? graph.successors(node).size() : graph.predecessors(node).size();
+        if (in_degrees[node] == 0)
+        {
+            ready.push_back(node);
+        }
+    }
+
+    levels_count = graph.size() == 0 ? 0 : 1;
+    while (!ready.empty())
+    {
+        const node_index_t node = ready.back();
+        ready.pop_back();
+        for (node_index_t next : reversed ? graph.predecessors(node) : graph.successors(node))
+        {
+            levels[next] = std::max(levels[next], levels[node] + 1);
+            if (--in_degrees[next] == 0)
+            {
+                levels_count = std::max(levels_count, levels[next] + 1);
+                ready.push_back(next);
+            }
+        }
+    }
+    return levels;
+}
+
+// Columns keep the nodes in the order of their indices
+template <typename T>
+parallel_sequencing_t<T> group_by_levels(const DirectedAcyclicGraph<T>& graph,
+                                         const std::vector<size_t>& levels, size_t levels_count)
+{
+    std::vector<size_t> columns_sizes(levels_count, 0);
+    for (size_t level : levels)
+    {
+        ++columns_sizes[level];
+    }
+    parallel_sequencing_t<T> parallel_sequencing(levels_count);
+    for (size_t level = 0; level != levels_count; ++level)
+    {
+        parallel_sequencing[level].reserve(columns_sizes[level]);
+    }
+    for (size_t node = 0; node != levels.size(); ++node)
+    {
+        parallel_sequencing[levels[node]].push_back(graph.value(node));
+    }
+    return parallel_sequencing;
+}
+
+}
+
+}
+
+template <typename T>
+std::vector<typename DirectedAcyclicGraph<T>::node_index_t> tree_algorithms::topological_order(const DirectedAcyclicGraph<T>& graph)
+{
+    typedef typename DirectedAcyclicGraph<T>::node_index_t node_index_t;
+
+    // The output buffer serves as the queue
+    std::vector<node_index_t> order;
+    order.reserve(graph.size());
+    std::vector<size_t> in_degrees(graph.size());
+    for (node_index_t node = 0; node != graph.size(); ++node)
+    {
+        in_degrees[node] = graph.predecessors(node).size();
+        if (in_degrees[node] == 0)
+        {
+            order.push_back(node);
+        }
+    }
+    for (size_t i = 0; i != order.size(); ++i)
+    {
+        for (node_index_t next : graph.successors(order[i]))
+        {
+            if (--in_degrees[next] == 0)
+            {
+                order.push_back(next);
+            }
+        }
+    }
+    return order;
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::lower_parallel_sequencing(const DirectedAcyclicGraph<T>& graph)
+{
+    size_t levels_count = 0;
+    const std::vector<size_t> levels = detail::graph_levels(graph, false, levels_count);
+    return detail::group_by_levels(graph, levels, levels_count);
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::upper_parallel_sequencing(const DirectedAcyclicGraph<T>& graph)
+{
+    size_t levels_count = 0;
+    const std::vector<size_t> levels = detail::graph_levels(graph, true, levels_count);
+    return detail::group_by_levels(graph, levels, levels_count);
+}
+
+#endif // GRAPHALGORITHMSIMPL_H
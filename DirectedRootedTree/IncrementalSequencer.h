@@ -0,0 +1,87 @@
+#ifndef INCREMENTALSEQUENCER_H
+#define INCREMENTALSEQUENCER_H
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "TreeAlgorithms.h"
+
+namespace tree_algorithms
+{
+
+// Keeps the lower and upper parallel sequencings of a tree up to date while the tree is edited.
+// An added node costs the path to the root, a removed node costs the subtrees of its children
+// and the path to the root. Heights are kept by counting the children of every height,
+// so the siblings on the path are not scanned.
+// The columns hold the same nodes as lower_parallel_sequencing and upper_parallel_sequencing,
+// but the order of the nodes inside of a column is unspecified.
+// The tree must outlive the sequencer.
+template <typename T>
+class IncrementalSequencer : private DirectedRootedTree<T>::Listener
+{
+public:
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+    typedef std::vector<const TreeNode*> level_t;
+
+public:
+    explicit IncrementalSequencer(DirectedRootedTree<T>& tree);
+    ~IncrementalSequencer();
+
+    IncrementalSequencer(const IncrementalSequencer&) = delete;
+    IncrementalSequencer& operator=(const IncrementalSequencer&) = delete;
+
+    size_t depth(const TreeNode* node) const;
+    size_t height(const TreeNode* node) const;
+
+    size_t lower_levels_count() const;
+    size_t upper_levels_count() const;
+
+    const level_t& lower_level(size_t column) const;
+    const level_t& upper_level(size_t column) const;
+
+    parallel_sequencing_t<T> lower_parallel_sequencing() const;
+    parallel_sequencing_t<T> upper_parallel_sequencing() const;
+
+private:
+    struct NodeState
+    {
+        size_t depth;
+        size_t height;
+        size_t lower_position;  /*!< Position in the lower level of the node */
+        size_t upper_position;  /*!< Position in the upper level of the node */
+        std::map<size_t, size_t> children_heights;  /*!< Children count by height of the child */
+    };
+
+    void node_added(const TreeNode* node) override;
+    void node_removing(const TreeNode* node) override;
+    void node_removed(const TreeNode* parent, size_t first_child, size_t children_count) override;
+    void tree_replaced() override;
+
+    void rebuild();
+    void update_depths(const TreeNode* parent, size_t first_child, size_t children_count);
+    void update_heights(const TreeNode* node);
+
+    static size_t children_height(const NodeState& state);
+    static void remove_child_height(NodeState& state, size_t height);
+
+    void set_depth(const TreeNode* node, NodeState& state, size_t depth);
+    void set_height(const TreeNode* node, NodeState& state, size_t height);
+
+    static void insert_node(std::vector<level_t>& levels, size_t column, const TreeNode* node, size_t& position);
+    void erase_node(std::vector<level_t>& levels, size_t column, size_t position, bool lower);
+
+    static parallel_sequencing_t<T> values(const std::vector<level_t>& levels);
+
+private:
+    DirectedRootedTree<T>& m_tree;
+    std::unordered_map<const TreeNode*, NodeState> m_states;
+    std::vector<level_t> m_lower_levels;    // Column is the depth minus one, the root is not included
+    std::vector<level_t> m_upper_levels;    // Column is the height
+};
+
+}
+
+#include "IncrementalSequencerImpl.h"
+
+#endif // INCREMENTALSEQUENCER_H
@@ -0,0 +1,317 @@
+#ifndef INCREMENTALSEQUENCERIMPL_H
+#define INCREMENTALSEQUENCERIMPL_H
+
+#include "IncrementalSequencer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+template <typename T>
+tree_algorithms::IncrementalSequencer<T>::IncrementalSequencer(DirectedRootedTree<T>& tree)
+    : m_tree(tree)
+{
+    rebuild();
+    m_tree.add_listener(this);
+}
+
+template <typename T>
+tree_algorithms::IncrementalSequencer<T>::~IncrementalSequencer()
+{
+    m_tree.remove_listener(this);
+}
+
+template <typename T>
+size_t tree_algorithms::IncrementalSequencer<T>::depth(const TreeNode* node) const
+{
+    return m_states.at(node).depth;
+}
+
+template <typename T>
+size_t tree_algorithms::IncrementalSequencer<T>::height(const TreeNode* node) const
+{
+    return m_states.at(node).height;
+}
+
+template <typename T>
+size_t tree_algorithms::IncrementalSequencer<T>::lower_levels_count() const
+{
+    return m_lower_levels.size();
+}
+
+template <typename T>
+size_t tree_algorithms::IncrementalSequencer<T>::upper_levels_count() const
+{
+    return m_upper_levels.size();
+}
+
+template <typename T>
+const typename tree_algorithms::IncrementalSequencer<T>::level_t&
+tree_algorithms::IncrementalSequencer<T>::lower_level(size_t column) const
+{
+    return m_lower_levels[column];
+}
+
+template <typename T>
+const typename tree_algorithms::IncrementalSequencer<T>::level_t&
+tree_algorithms::IncrementalSequencer<T>::upper_level(size_t column) const
+{
+    return m_upper_levels[column];
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::IncrementalSequencer<T>::lower_parallel_sequencing() const
+{
+    return values(m_lower_levels);
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::IncrementalSequencer<T>::upper_parallel_sequencing() const
+{
+    return values(m_upper_levels);
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::node_added(const TreeNode* node)
+{
+    NodeState state = NodeState();
+    state.depth = m_states.at(node->parent()).depth + 1;
+    NodeState& added_state = m_states.emplace(node, state).first->second;
+    insert_node(m_lower_levels, added_state.depth - 1, node, added_state.lower_position);
+    insert_node(m_upper_levels, 0, node, added_state.upper_position);
+
+    ++m_states.at(node->parent()).children_heights[0];
+    update_heights(node->parent());
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::node_removing(const TreeNode* node)
+{
+    typename std::unordered_map<const TreeNode*, NodeState>::iterator iter = m_states.find(node);
+    if (iter == m_states.end())
+    {
+        throw std::runtime_error("Inconsistent sequencer: node is not tracked");
+    }
+    // The children of the node go to its nearest ancestor which is not removed in the same batch,
+    // their heights are counted there before any node is relinked
+    const TreeNode* ancestor = node->parent();
+    typename std::unordered_map<const TreeNode*, NodeState>::iterator ancestor_iter = m_states.find(ancestor);
+    while (ancestor_iter == m_states.end())
+    {
+        ancestor = ancestor->parent();
+        ancestor_iter = m_states.find(ancestor);
+    }
+    NodeState& ancestor_state = ancestor_iter->second;
+    remove_child_height(ancestor_state, iter->second.height);
+    for (const std::pair<const size_t, size_t>& child_height : iter->second.children_heights)
+    {
+        ancestor_state.children_heights[child_height.first] += child_height.second;
+    }
+    erase_node(m_lower_levels, iter->second.depth - 1, iter->second.lower_position, true);
+    erase_node(m_upper_levels, iter->second.height, iter->second.upper_position, false);
+    m_states.erase(iter);
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::node_removed(const TreeNode* parent,
+                                                            size_t first_child, size_t children_count)
+{
+    update_depths(parent, first_child, children_count);
+    update_heights(parent);
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::tree_replaced()
+{
+    rebuild();
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::rebuild()
+{
+    m_states.clear();
+    m_lower_levels.clear();
+    m_upper_levels.clear();
+    if (!m_tree.root())
+    {
+        return;
+    }
+
+    const DirectedRootedTree<T>& tree = m_tree;
+    m_states.reserve(tree.size());
+    for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+    {
+        const TreeNode* node = iter.current_node();
+        NodeState state = NodeState();
+        state.depth = node->parent() ? m_states.at(node->parent()).depth + 1 : 0;
+        m_states.emplace(node, state);
+    }
+    for (typename DirectedRootedTree<T>::PostorderIterator iter = tree.postorder().begin();
+         iter != tree.postorder().end();
+         ++iter)
+    {
+        NodeState& state = m_states.at(iter.current_node());
+        for (const typename DirectedRootedTree<T>::node_ptr_t& child : iter.current_node()->children())
+        {
+            ++state.children_heights[m_states.at(child.get()).height];
+        }
+        state.height = children_height(state);
+    }
+
+    // Columns start in preorder, like the ones of the full sequencings
+    for (typename DirectedRootedTree<T>::ConstIterator iter = ++tree.cbegin(); iter != tree.cend(); ++iter)
+    {
+        NodeState& state = m_states.at(iter.current_node());
+        insert_node(m_lower_levels, state.depth - 1, iter.current_node(), state.lower_position);
+        insert_node(m_upper_levels, state.height, iter.current_node(), state.upper_position);
+    }
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::update_depths(const TreeNode* parent,
+                                                             size_t first_child, size_t children_count)
+{
+    // Only the subtrees of the spliced children are moved up
+    std::vector< std::pair<const TreeNode*, size_t> > pending;     // Node and its new depth
+    const size_t child_depth = m_states.at(parent).depth + 1;
+    for (size_t i = first_child; i != first_child + children_count; ++i)
+    {
+        pending.emplace_back(parent->children()[i].get(), child_depth);
+    }
+    while (!pending.empty())
+    {
+        const TreeNode* node = pending.back().first;
+        const size_t depth = pending.back().second;
+        pending.pop_back();
+
+        // Depths of a whole subtree change together, so a node with the right depth
+        // has the right depths below it
+        NodeState& state = m_states.at(node);
+        if (state.depth == depth)
+        {
+            continue;
+        }
+        set_depth(node, state, depth);
+        for (const typename DirectedRootedTree<T>::node_ptr_t& child : node->children())
+        {
+            pending.emplace_back(child.get(), depth + 1);
+        }
+    }
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::update_heights(const TreeNode* node)
+{
+    // A changed height is moved between the counts of the parent, up to the first unchanged ancestor
+    NodeState* state = &m_states.at(node);
+    while (true)
+    {
+        const size_t height = children_height(*state);
+        if (state->height == height)
+        {
+            return;
+        }
+        const TreeNode* parent = node->parent();
+        if (!parent)
+        {
+            set_height(node, *state, height);
+            return;
+        }
+        NodeState& parent_state = m_states.at(parent);
+        remove_child_height(parent_state, state->height);
+        ++parent_state.children_heights[height];
+        set_height(node, *state, height);
+
+        node = parent;
+        state = &parent_state;
+    }
+}
+
+template <typename T>
+size_t tree_algorithms::IncrementalSequencer<T>::children_height(const NodeState& state)
+{
+    return state.children_heights.empty() ? 0 : state.children_heights.rbegin()->first + 1;
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::remove_child_height(NodeState& state, size_t height)
+{
+    std::map<size_t, size_t>::iterator iter = state.children_heights.find(height);
+    if (iter == state.children_heights.end())
+    {
+        throw std::runtime_error("Inconsistent sequencer: child height is not counted");
+    }
+    if (--iter->second == 0)
+    {
+        state.children_heights.erase(iter);
+    }
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::set_depth(const TreeNode* node, NodeState& state, size_t depth)
+{
+    erase_node(m_lower_levels, state.depth - 1, state.lower_position, true);
+    state.depth = depth;
+    insert_node(m_lower_levels, state.depth - 1, node, state.lower_position);
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::set_height(const TreeNode* node, NodeState& state, size_t height)
+{
+    if (!node->parent())
+    {
+        state.height = height;
+        return;
+    }
+    erase_node(m_upper_levels, state.height, state.upper_position, false);
+    state.height = height;
+    insert_node(m_upper_levels, state.height, node, state.upper_position);
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::insert_node(std::vector<level_t>& levels, size_t column,
+                                                           const TreeNode* node, size_t& position)
+{
+    if (column >= levels.size())
+    {
+        levels.resize(column + 1);
+    }
+    position = levels[column].size();
+    levels[column].push_back(node);
+}
+
+template <typename T>
+void tree_algorithms::IncrementalSequencer<T>::erase_node(std::vector<level_t>& levels, size_t column,
+                                                          size_t position, bool lower)
+{
+    // The last node of the level takes the place of the erased one
+    level_t& level = levels[column];
+    const TreeNode* moved = level.back();
+    level[position] = moved;
+    level.pop_back();
+    if (position != level.size())
+    {
+        NodeState& moved_state = m_states.at(moved);
+        (lower ? moved_state.lower_position : moved_state.upper_position) = position;
+    }
+    while (!levels.empty() && levels.back().empty())
+    {
+        levels.pop_back();
+    }
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::IncrementalSequencer<T>::values(const std::vector<level_t>& levels)
+{
+    parallel_sequencing_t<T> parallel_sequencing(levels.size());
+    for (size_t column = 0; column != levels.size(); ++column)
+    {
+        parallel_sequencing[column].reserve(levels[column].size());
+        for (const TreeNode* node : levels[column])
+        {
+            parallel_sequencing[column].push_back(node->value());
+        }
+    }
+    return parallel_sequencing;
+}
+
+#endif // INCREMENTALSEQUENCERIMPL_H
@@ -0,0 +1,177 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Slab allocator for tree nodes.
+// Nodes are carved from large contiguous slabs, destroyed nodes go to a free list
+// and are reused by the next create(). Releasing the pool frees all slabs at once,
+// it is the owner's responsibility to destroy live nodes before that.
+template <typename TNode>
+class NodePool
+{
+public:
+    explicit NodePool(size_t initial_slab_size = 64, size_t max_slab_size = 64 * 1024);
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    template <typename... Args>
+    TNode* create(Args&&... args);
+
+    void destroy(TNode* node);          // Destroys the node and puts its slot to the free list
+    void destroy_in_place(TNode* node); // Destroys the node without reusing its slot
+
+    void reserve(size_t count);
+
+    // Takes over the slabs and the free slots of the other pool, which is left empty.
+    // Nodes created by the other pool are then destroyed by this one.
+    void adopt(NodePool& other);
+
+    size_t capacity() const;
+
+private:
+    union Slot
+    {
+        Slot* next;
+        typename std::aligned_storage<sizeof(TNode), alignof(TNode)>::type storage;
+    };
+
+    void* allocate_slot();
+    void add_slab(size_t slab_size);
+
+private:
+    std::vector< std::unique_ptr<Slot[]> > m_slabs;
+    Slot* m_free_list;
+    Slot* m_cursor;
+    Slot* m_slab_end;
+    size_t m_next_slab_size;
+    size_t m_max_slab_size;
+    size_t m_capacity;
+};
+
+template <typename TNode>
+NodePool<TNode>::NodePool(size_t initial_slab_size, size_t max_slab_size)
+    : m_free_list(nullptr),
+      m_cursor(nullptr),
+      m_slab_end(nullptr),
+      m_next_slab_size(initial_slab_size ? initial_slab_size : 1),
+      m_max_slab_size(std::max(max_slab_size, m_next_slab_size)),
+      m_capacity(0)
+{
+
+}
+
+template <typename TNode>
+template <typename... Args>
+TNode* NodePool<TNode>::create(Args&&... args)
+{
+    void* slot = allocate_slot();
+    try
+    {
+        return new (slot) TNode(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        Slot* free_slot = static_cast<Slot*>(slot);
+        free_slot->next = m_free_list;
+        m_free_list = free_slot;
+        throw;
+    }
+}
+
+template <typename TNode>
+void NodePool<TNode>::destroy(TNode* node)
+{
+    node->~TNode();
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    slot->next = m_free_list;
+    m_free_list = slot;
+}
+
+template <typename TNode>
+void NodePool<TNode>::destroy_in_place(TNode* node)
+{
+    node->~TNode();
+}
+
+template <typename TNode>
+void NodePool<TNode>::reserve(size_t count)
+{
+    if (static_cast<size_t>(m_slab_end - m_cursor) < count)
+    {
+        add_slab(count);
+    }
+}
+
+template <typename TNode>
+void NodePool<TNode>::adopt(NodePool& other)
+{
+    while (other.m_free_list)
+    {
+        Slot* slot = other.m_free_list;
+        other.m_free_list = slot->next;
+        slot->next = m_free_list;
+        m_free_list = slot;
+    }
+    while (other.m_cursor != other.m_slab_end)
+    {
+        other.m_cursor->next = m_free_list;
+        m_free_list = other.m_cursor++;
+    }
+    m_slabs.insert(m_slabs.end(),
+                   std::make_move_iterator(other.m_slabs.begin()),
+                   std::make_move_iterator(other.m_slabs.end()));
+    m_capacity += other.m_capacity;
+
+    other.m_slabs.clear();
+    other.m_cursor = nullptr;
+    other.m_slab_end = nullptr;
+    other.m_capacity = 0;
+}
+
+template <typename TNode>
+size_t NodePool<TNode>::capacity() const
+{
+    return m_capacity;
+}
+
+template <typename TNode>
+void* NodePool<TNode>::allocate_slot()
+{
+    if (m_free_list)
+    {
+        Slot* slot = m_free_list;
+        m_free_list = slot->next;
+        return slot;
+    }
+    if (m_cursor == m_slab_end)
+    {
+        add_slab(m_next_slab_size);
+        m_next_slab_size = std::min(m_next_slab_size * 2, m_max_slab_size);
+    }
+    return m_cursor++;
+}
+
+template <typename TNode>
+void NodePool<TNode>::add_slab(size_t slab_size)
+{
+    // Unused slots of the current slab are not lost: push them to the free list
+    while (m_cursor != m_slab_end)
+    {
+        m_cursor->next = m_free_list;
+        m_free_list = m_cursor++;
+    }
+    m_slabs.emplace_back(new Slot[slab_size]);
+    m_cursor = m_slabs.back().get();
+    m_slab_end = m_cursor + slab_size;
+    m_capacity += slab_size;
+}
+
+#endif // NODEPOOL_H
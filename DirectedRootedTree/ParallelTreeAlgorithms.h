@@ -0,0 +1,63 @@
+#ifndef PARALLELTREEALGORITHMS_H
+#define PARALLELTREEALGORITHMS_H
+
+#include <thread>
+
+#include "TreeAlgorithms.h"
+#include "WorkStealingPool.h"
+
+namespace tree_algorithms
+{
+
+struct parallel_options
+{
+    explicit parallel_options(size_t threads_count = std::thread::hardware_concurrency(),
+                              size_t serial_threshold = 100000);
+
+    size_t threads_count;
+    size_t serial_threshold;    /*!< Trees smaller than this are processed by the serial algorithm */
+};
+
+// Same result as the serial lower_parallel_sequencing.
+// Subtrees below the first level wide enough to load all threads are processed as separate tasks.
+template <typename T>
+parallel_sequencing_t<T> lower_parallel_sequencing(const DirectedRootedTree<T>& tree,
+                                                   const parallel_options& options);
+
+// Same result as the serial upper_parallel_sequencing.
+template <typename T>
+parallel_sequencing_t<T> upper_parallel_sequencing(const DirectedRootedTree<T>& tree,
+                                                   const parallel_options& options);
+
+// Calls the function for the value of every node, in no particular order.
+// The nodes are split in preorder into chunks of the same size: a subtree is contiguous in preorder,
+// so a large subtree is spread over several tasks instead of keeping one thread busy.
+// Rethrows the first exception thrown by the function.
+// Values are changed in place, so afterwards, also on an exception, the structural hashes are recomputed
+// if enabled and the listeners receive tree_replaced. Both cost a serial pass, functions which only read
+// the values should be given the const tree instead.
+template <typename T, typename TFunction>
+void parallel_for_each(DirectedRootedTree<T>& tree, TFunction function,
+                       const parallel_options& options = parallel_options());
+
+template <typename T, typename TFunction>
+void parallel_for_each(const DirectedRootedTree<T>& tree, TFunction function,
+                       const parallel_options& options = parallel_options());
+
+// Every chunk folds its values in preorder with reduce(TResult, const T&) starting from the identity,
+// then the results of the chunks are folded in preorder with combine(TResult, TResult).
+// The identity must not change the result of combine, and combine must be associative.
+template <typename T, typename TResult, typename TReduce, typename TCombine>
+TResult parallel_reduce(const DirectedRootedTree<T>& tree, TResult identity, TReduce reduce, TCombine combine,
+                        const parallel_options& options = parallel_options());
+
+// Same as above, with combine used both for the values and for the chunk results
+template <typename T, typename TResult, typename TCombine>
+TResult parallel_reduce(const DirectedRootedTree<T>& tree, TResult identity, TCombine combine,
+                        const parallel_options& options = parallel_options());
+
+}
+
+#include "ParallelTreeAlgorithmsImpl.h"
+
+#endif // PARALLELTREEALGORITHMS_H
@@ -0,0 +1,463 @@
+#ifndef PARALLELTREEALGORITHMSIMPL_H
+#define PARALLELTREEALGORITHMSIMPL_H
+
+#include "ParallelTreeAlgorithms.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+inline tree_algorithms::parallel_options::parallel_options(size_t threads_count, size_t serial_threshold)
+    : threads_count(threads_count),
+      serial_threshold(serial_threshold)
+{
+
+}
+
+namespace tree_algorithms
+{
+namespace detail
+{
+
+// Part of the tree processed at once: either a single node above the split depth
+// or the whole subtree of a node at the split depth.
+// Segments are kept in preorder, so concatenating their columns gives the columns of the tree.
+template <typename T>
+struct sequencing_segment
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    sequencing_segment(const TreeNode* node, size_t depth, bool is_subtree)
+        : node(node),
+          depth(depth),
+          is_subtree(is_subtree),
+          first_column(0)
+    {
+
+    }
+
+    const TreeNode* node;
+    size_t depth;
+    bool is_subtree;
+    size_t first_column;
+    std::vector< std::vector<const TreeNode*> > columns;
+};
+
+template <typename T>
+std::vector< sequencing_segment<T> > split_tree(const DirectedRootedTree<T>& tree, size_t min_subtrees_count)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    // Find the first level wide enough to give work to all threads
+    size_t split_depth = 1;
+    std::vector<const TreeNode*> level;
+    for (const typename DirectedRootedTree<T>::node_ptr_t& child : tree.root()->children())
+    {
+        level.push_back(child.get());
+    }
+    while (level.size() < min_subtrees_count)
+    {
+        std::vector<const TreeNode*> next_level;
+        for (const TreeNode* node : level)
+        {
+            for (const typename DirectedRootedTree<T>::node_ptr_t& child : node->children())
+            {
+                next_level.push_back(child.get());
+            }
+        }
+        if (next_level.empty())
+        {
+            break;
+        }
+        level.swap(next_level);
+        ++split_depth;
+    }
+
+    std::vector< sequencing_segment<T> > segments;
+    std::vector< std::pair<const TreeNode*, size_t> > pending;
+    const typename DirectedRootedTree<T>::node_children_t& root_children = tree.root()->children();
+    for (auto iter = root_children.rbegin(); iter != root_children.rend(); ++iter)
+    {
+        pending.emplace_back(iter->get(), 1);
+    }
+    while (!pending.empty())
+    {
+        const TreeNode* node = pending.back().first;
+        size_t depth = pending.back().second;
+        pending.pop_back();
+
+        segments.emplace_back(node, depth, depth == split_depth);
+        if (depth < split_depth)
+        {
+            for (auto iter = node->children().rbegin(); iter != node->children().rend(); ++iter)
+            {
+                pending.emplace_back(iter->get(), depth + 1);
+            }
+        }
+    }
+    return segments;
+}
+
+template <typename T>
+void collect_levels(sequencing_segment<T>& segment)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    segment.first_column = segment.depth - 1;
+    segment.columns.emplace_back(1, segment.node);
+    while (true)
+    {
+        std::vector<const TreeNode*> next_level;
+        for (const TreeNode* node : segment.columns.back())
+        {
+            for (const typename DirectedRootedTree<T>::node_ptr_t& child : node->children())
+            {
+                next_level.push_back(child.get());
+            }
+        }
+        if (next_level.empty())
+        {
+            break;
+        }
+        segment.columns.push_back(std::move(next_level));
+    }
+}
+
+template <typename T>
+void collect_heights(sequencing_segment<T>& segment)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    segment.first_column = 0;
+
+    // Postorder traversal of the subtree, see upper_parallel_sequencing
+    std::vector<size_t> heights;
+    std::vector< std::pair<const TreeNode*, size_t> > path(1, std::make_pair(segment.node, 0));
+    while (!path.empty())
+    {
+        const TreeNode* node = path.back().first;
+        size_t& next_child = path.back().second;
+        if (next_child != node->children().size())
+        {
+            path.emplace_back(node->children()[next_child++].get(), 0);
+            continue;
+        }
+        path.pop_back();
+
+        const size_t children_count = node->children().size();
+        size_t height = 0;
+        for (size_t i = heights.size() - children_count; i != heights.size(); ++i)
+        {
+            height = std::max(height, heights[i] + 1);
+        }
+        heights.resize(heights.size() - children_count);
+        heights.push_back(height);
+
+        if (height >= segment.columns.size())
+        {
+            segment.columns.resize(height + 1);
+        }
+        segment.columns[height].push_back(node);
+    }
+}
+
+// Parts of an output column in the order of the segments
+template <typename T>
+using column_parts_t = std::vector<const std::vector<const typename DirectedRootedTree<T>::TreeNode*>*>;
+
+template <typename T>
+void fill_columns(const std::vector< column_parts_t<T> >& columns_parts, size_t first_column, size_t last_column,
+                  parallel_sequencing_t<T>& parallel_sequencing)
+{
+    for (size_t column = first_column; column != last_column; ++column)
+    {
+        size_t column_size = 0;
+        for (const std::vector<const typename DirectedRootedTree<T>::TreeNode*>* part : columns_parts[column])
+        {
+            column_size += part->size();
+        }
+        std::vector<T>& values = parallel_sequencing[column];
+        values.reserve(column_size);
+        for (const std::vector<const typename DirectedRootedTree<T>::TreeNode*>* part : columns_parts[column])
+        {
+            for (const typename DirectedRootedTree<T>::TreeNode* node : *part)
+            {
+                values.push_back(node->value());
+            }
+        }
+    }
+}
+
+// Every output column is filled by one task only, so no locking is needed.
+// Values are only copied, as by the serial functions.
+template <typename T>
+parallel_sequencing_t<T> merge_segments(const std::vector< sequencing_segment<T> >& segments, WorkStealingPool& pool)
+{
+    std::vector< column_parts_t<T> > columns_parts;
+    size_t nodes_count = 0;
+    for (const sequencing_segment<T>& segment : segments)
+    {
+        for (size_t i = 0; i != segment.columns.size(); ++i)
+        {
+            const size_t column = segment.first_column + i;
+            if (column >= columns_parts.size())
+            {
+                columns_parts.resize(column + 1);
+            }
+            columns_parts[column].push_back(&segment.columns[i]);
+            nodes_count += segment.columns[i].size();
+        }
+    }
+
+    // Narrow columns are filled together, so a deep tree does not make a task per column
+    parallel_sequencing_t<T> parallel_sequencing(columns_parts.size());
+    const size_t task_size = std::max<size_t>(nodes_count / (pool.threads_count() * 8), 1);
+    size_t first_column = 0;
+    size_t task_nodes_count = 0;
+    for (size_t column = 0; column != columns_parts.size(); ++column)
+    {
+        for (const std::vector<const typename DirectedRootedTree<T>::TreeNode*>* part : columns_parts[column])
+        {
+            task_nodes_count += part->size();
+        }
+        if (task_nodes_count >= task_size || column + 1 == columns_parts.size())
+        {
+            const size_t last_column = column + 1;
+            pool.submit([&columns_parts, first_column, last_column, &parallel_sequencing]()
+            {
+                fill_columns<T>(columns_parts, first_column, last_column, parallel_sequencing);
+            });
+            first_column = last_column;
+            task_nodes_count = 0;
+        }
+    }
+    pool.wait();
+
+    return parallel_sequencing;
+}
+
+template <typename T>
+std::vector<const typename DirectedRootedTree<T>::TreeNode*> preorder_nodes(const DirectedRootedTree<T>& tree)
+{
+    std::vector<const typename DirectedRootedTree<T>::TreeNode*> nodes;
+    nodes.reserve(tree.size());
+    for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+    {
+        nodes.push_back(iter.current_node());
+    }
+    return nodes;
+}
+
+// Runs the function for every chunk [begin, end) of the nodes in preorder, passing the chunk index
+template <typename T, typename TChunkFunction>
+void for_each_chunk(const std::vector<const typename DirectedRootedTree<T>::TreeNode*>& nodes, size_t chunks_count,
+                    size_t threads_count, TChunkFunction chunk_function)
+{
+    WorkStealingPool pool(threads_count);
+    for (size_t chunk = 0; chunk != chunks_count; ++chunk)
+    {
+        const size_t begin = chunk * nodes.size() / chunks_count;
+        const size_t end = (chunk + 1) * nodes.size() / chunks_count;
+        pool.submit([&chunk_function, &nodes, chunk, begin, end]()
+        {
+            chunk_function(nodes.data() + begin, nodes.data() + end, chunk);
+        });
+    }
+    pool.wait();
+}
+
+inline size_t chunks_count(size_t nodes_count, const parallel_options& options)
+{
+    // Several chunks per thread let the threads steal work from each other
+    return std::min(nodes_count, options.threads_count * 8);
+}
+
+}
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::lower_parallel_sequencing(const DirectedRootedTree<T>& tree,
+                                                                                     const parallel_options& options)
+{
+    if (options.threads_count < 2 || tree.size() < options.serial_threshold)
+    {
+        return lower_parallel_sequencing(tree);
+    }
+
+    WorkStealingPool pool(options.threads_count);
+    std::vector< detail::sequencing_segment<T> > segments = detail::split_tree(tree, options.threads_count * 8);
+    for (detail::sequencing_segment<T>& segment : segments)
+    {
+        if (segment.is_subtree)
+        {
+            pool.submit([&segment]()
+            {
+                detail::collect_levels(segment);
+            });
+        }
+        else
+        {
+            segment.first_column = segment.depth - 1;
+            segment.columns.emplace_back(1, segment.node);
+        }
+    }
+    pool.wait();
+
+    return detail::merge_segments(segments, pool);
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::upper_parallel_sequencing(const DirectedRootedTree<T>& tree,
+                                                                                     const parallel_options& options)
+{
+    if (options.threads_count < 2 || tree.size() < options.serial_threshold)
+    {
+        return upper_parallel_sequencing(tree);
+    }
+
+    WorkStealingPool pool(options.threads_count);
+    std::vector< detail::sequencing_segment<T> > segments = detail::split_tree(tree, options.threads_count * 8);
+    for (detail::sequencing_segment<T>& segment : segments)
+    {
+        if (segment.is_subtree)
+        {
+            pool.submit([&segment]()
+            {
+                detail::collect_heights(segment);
+            });
+        }
+    }
+    pool.wait();
+
+    // Heights of the nodes above the split depth, children go after their parents in preorder
+    std::unordered_map<const typename DirectedRootedTree<T>::TreeNode*, size_t> heights;
+    for (auto iter = segments.rbegin(); iter != segments.rend(); ++iter)
+    {
+        if (iter->is_subtree)
+        {
+            heights[iter->node] = iter->columns.size() - 1;
+            continue;
+        }
+        size_t height = 0;
+        for (const typename DirectedRootedTree<T>::node_ptr_t& child : iter->node->children())
+        {
+            height = std::max(height, heights[child.get()] + 1);
+        }
+        heights[iter->node] = height;
+        iter->first_column = height;
+        iter->columns.emplace_back(1, iter->node);
+    }
+
+    return detail::merge_segments(segments, pool);
+}
+
+template <typename T, typename TFunction>
+void tree_algorithms::parallel_for_each(DirectedRootedTree<T>& tree, TFunction function, const parallel_options& options)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    const bool observed = tree.structural_hashing_enabled() || tree.has_listeners();
+    try
+    {
+        if (options.threads_count < 2 || tree.size() < options.serial_threshold)
+        {
+            std::for_each(tree.begin(), tree.end(), function);
+        }
+        else
+        {
+            const DirectedRootedTree<T>& const_tree = tree;
+            const std::vector<const TreeNode*> nodes = detail::preorder_nodes(const_tree);
+            detail::for_each_chunk<T>(nodes, detail::chunks_count(nodes.size(), options), options.threads_count,
+                                      [&function](const TreeNode* const* begin, const TreeNode* const* end, size_t)
+            {
+                for (; begin != end; ++begin)
+                {
+                    // The tree itself is not const
+                    function(const_cast<TreeNode*>(*begin)->value());
+                }
+            });
+        }
+    }
+    catch (...)
+    {
+        if (observed)
+        {
+            tree.values_replaced();
+        }
+        throw;
+    }
+    if (observed)
+    {
+        tree.values_replaced();
+    }
+}
+
+template <typename T, typename TFunction>
+void tree_algorithms::parallel_for_each(const DirectedRootedTree<T>& tree, TFunction function, const parallel_options& options)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    if (options.threads_count < 2 || tree.size() < options.serial_threshold)
+    {
+        std::for_each(tree.cbegin(), tree.cend(), function);
+        return;
+    }
+
+    const std::vector<const TreeNode*> nodes = detail::preorder_nodes(tree);
+    detail::for_each_chunk<T>(nodes, detail::chunks_count(nodes.size(), options), options.threads_count,
+                              [&function](const TreeNode* const* begin, const TreeNode* const* end, size_t)
+    {
+        for (; begin != end; ++begin)
+        {
+            function((*begin)->value());
+        }
+    });
+}
+
+template <typename T, typename TResult, typename TReduce, typename TCombine>
+TResult tree_algorithms::parallel_reduce(const DirectedRootedTree<T>& tree, TResult identity, TReduce reduce,
+                                         TCombine combine, const parallel_options& options)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    if (options.threads_count < 2 || tree.size() < options.serial_threshold)
+    {
+        TResult result = identity;
+        for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+        {
+            result = reduce(std::move(result), *iter);
+        }
+        return result;
+    }
+
+    const std::vector<const TreeNode*> nodes = detail::preorder_nodes(tree);
+    const size_t chunks_count = detail::chunks_count(nodes.size(), options);
+    std::vector<TResult> chunk_results(chunks_count, identity);
+    detail::for_each_chunk<T>(nodes, chunks_count, options.threads_count,
+                              [&reduce, &chunk_results](const TreeNode* const* begin, const TreeNode* const* end,
+                                                        size_t chunk)
+    {
+        TResult result = chunk_results[chunk];
+        for (; begin != end; ++begin)
+        {
+            result = reduce(std::move(result), (*begin)->value());
+        }
+        chunk_results[chunk] = std::move(result);
+    });
+
+    TResult result = std::move(identity);
+    for (TResult& chunk_result : chunk_results)
+    {
+        result = combine(std::move(result), std::move(chunk_result));
+    }
+    return result;
+}
+
+template <typename T, typename TResult, typename TCombine>
+TResult tree_algorithms::parallel_reduce(const DirectedRootedTree<T>& tree, TResult identity, TCombine combine,
+                                         const parallel_options& options)
+{
+    return parallel_reduce(tree, std::move(identity), combine, combine, options);
+}
+
+#endif // PARALLELTREEALGORITHMSIMPL_H
@@ -0,0 +1,99 @@
+#ifndef PERSISTENTDIRECTEDROOTEDTREE_H
+#define PERSISTENTDIRECTEDROOTEDTREE_H
+
+#include <memory>
+#include <vector>
+
+#include "DirectedRootedTree.h"
+
+// Immutable counterpart of DirectedRootedTree.
+// Every edit returns a new version of the tree which shares all untouched subtrees with the old one:
+// only the nodes on the path from the root to the edited node are copied.
+// Copying a version is O(1), nodes are addressed by their paths of child indices from the root.
+template <typename T>
+class PersistentDirectedRootedTree
+{
+    friend bool operator==(const PersistentDirectedRootedTree& left, const PersistentDirectedRootedTree& right)
+    {
+        return equal(left, right);
+    }
+
+    friend bool operator!=(const PersistentDirectedRootedTree& left, const PersistentDirectedRootedTree& right)
+    {
+        return !equal(left, right);
+    }
+
+public:
+    class Node;
+
+    typedef std::shared_ptr<const Node> node_ptr_t;
+    typedef std::vector<node_ptr_t> node_children_t;
+    typedef std::vector<size_t> node_path_t;
+
+    class Node
+    {
+        friend class PersistentDirectedRootedTree;
+
+    public:
+        Node(const T& value, node_children_t&& children);
+        ~Node();
+
+        Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+        const T& value() const;
+        const node_children_t& children() const;
+
+    private:
+        T m_value;
+        node_children_t m_children;
+    };
+
+public:
+    // Compares the values and the shapes, shared subtrees are not visited
+    static bool equal(const PersistentDirectedRootedTree& left, const PersistentDirectedRootedTree& right);
+
+    // Builds the tree from the values in preorder and the preorder indices of their parents,
+    // the parent of the root is ignored
+    static PersistentDirectedRootedTree from_preorder(const std::vector<T>& values, const std::vector<size_t>& parents);
+
+public:
+    explicit PersistentDirectedRootedTree(const T& value = T());
+    // Throws std::invalid_argument if the tree has no root
+    explicit PersistentDirectedRootedTree(const DirectedRootedTree<T>& tree);
+
+    // Copies are O(1), so a moved-from tree stays a valid copy
+    PersistentDirectedRootedTree(const PersistentDirectedRootedTree& other) = default;
+    PersistentDirectedRootedTree& operator=(const PersistentDirectedRootedTree& other) = default;
+
+    DirectedRootedTree<T> to_tree() const;
+
+    const Node* root() const;
+    // Throws std::out_of_range if there is no node at the path
+    const Node* node(const node_path_t& path) const;
+
+    size_t size() const;
+
+    PersistentDirectedRootedTree add_child(const node_path_t& parent, const T& value) const;
+    // Children of the removed node take its place in the children list of its parent
+    PersistentDirectedRootedTree remove_node(const node_path_t& node) const;
+    PersistentDirectedRootedTree set_value(const node_path_t& node, const T& value) const;
+
+private:
+    PersistentDirectedRootedTree(node_ptr_t root, size_t size);
+
+    std::vector<const Node*> path_nodes(const node_path_t& path) const;
+    // Copies the ancestors of the node at path[0, depth), the node itself is replaced by the given one
+    node_ptr_t replace_node(const std::vector<const Node*>& nodes, const node_path_t& path,
+                            size_t depth, node_ptr_t replacement) const;
+
+    static node_ptr_t make_node(const T& value, node_children_t&& children);
+
+private:
+    node_ptr_t m_root;
+    size_t m_size;
+};
+
+#include "PersistentDirectedRootedTreeImpl.h"
+
+#endif // PERSISTENTDIRECTEDROOTEDTREE_H
@@ -0,0 +1,297 @@
+#ifndef PERSISTENTDIRECTEDROOTEDTREEIMPL_H
+#define PERSISTENTDIRECTEDROOTEDTREEIMPL_H
+
+#include "PersistentDirectedRootedTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+template <typename T>
+PersistentDirectedRootedTree<T>::Node::Node(const T& value, node_children_t&& children)
+    : m_value(value),
+      m_children(std::move(children))
+{
+
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T>::Node::~Node()
+{
+    // Releasing the children one by one instead of recursively keeps deep trees off the stack.
+    // A node whose last owner is this node is emptied before it is released.
+    node_children_t pending;
+    pending.swap(m_children);
+    while (!pending.empty())
+    {
+        node_ptr_t node = std::move(pending.back());
+        pending.pop_back();
+        if (node.use_count() == 1)
+        {
+            // The other owners could have been released by other threads: synchronize with their
+            // releases before the node is changed, as the release of the last shared_ptr does
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // Nodes are never created const, only shared as such
+            node_children_t& children = const_cast<Node&>(*node).m_children;
+            for (node_ptr_t& child : children)
+            {
+                pending.push_back(std::move(child));
+            }
+            children.clear();
+        }
+    }
+}
+
+template <typename T>
+const T& PersistentDirectedRootedTree<T>::Node::value() const
+{
+    return m_value;
+}
+
+template <typename T>
+const typename PersistentDirectedRootedTree<T>::node_children_t& PersistentDirectedRootedTree<T>::Node::children() const
+{
+    return m_children;
+}
+
+template <typename T>
+bool PersistentDirectedRootedTree<T>::equal(const PersistentDirectedRootedTree& left, const PersistentDirectedRootedTree& right)
+{
+    if (left.m_size != right.m_size)
+    {
+        return false;
+    }
+
+    std::vector< std::pair<const Node*, const Node*> > pending(1, std::make_pair(left.root(), right.root()));
+    while (!pending.empty())
+    {
+        const Node* left_node = pending.back().first;
+        const Node* right_node = pending.back().second;
+        pending.pop_back();
+        if (left_node == right_node)
+        {
+            continue;
+        }
+        if (!(left_node->value() == right_node->value()) ||
+            left_node->children().size() != right_node->children().size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i != left_node->children().size(); ++i)
+        {
+            pending.emplace_back(left_node->children()[i].get(), right_node->children()[i].get());
+        }
+    }
+    return true;
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T> PersistentDirectedRootedTree<T>::from_preorder(const std::vector<T>& values,
+                                                                               const std::vector<size_t>& parents)
+{
+    if (values.empty() || values.size() != parents.size())
+    {
+        throw std::invalid_argument("Preorder must hold the root and a parent for every value");
+    }
+    for (size_t i = 1; i != parents.size(); ++i)
+    {
+        if (parents[i] >= i)
+        {
+            throw std::invalid_argument("Parent must precede its children in preorder");
+        }
+    }
+
+    // Children are complete before their parent in reverse preorder, they are collected last to first
+    std::vector<node_children_t> children(values.size());
+    for (size_t i = values.size(); i-- != 0; )
+    {
+        std::reverse(children[i].begin(), children[i].end());
+        node_ptr_t node = make_node(values[i], std::move(children[i]));
+        if (i == 0)
+        {
+            return PersistentDirectedRootedTree(std::move(node), values.size());
+        }
+        children[parents[i]].push_back(std::move(node));
+    }
+    return PersistentDirectedRootedTree();
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T>::PersistentDirectedRootedTree(const T& value)
+    : m_root(make_node(value, node_children_t())),
+      m_size(1)
+{
+
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T>::PersistentDirectedRootedTree(const DirectedRootedTree<T>& tree)
+    : m_size(0)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    if (!tree.root())
+    {
+        throw std::invalid_argument("Tree has no root");
+    }
+
+    std::vector<T> values;
+    std::vector<size_t> parents;
+    values.reserve(tree.size());
+    parents.reserve(tree.size());
+
+    std::vector< std::pair<const TreeNode*, size_t> > pending(1, std::make_pair(tree.root(), size_t(0)));
+    while (!pending.empty())
+    {
+        const TreeNode* node = pending.back().first;
+        const size_t index = values.size();
+        parents.push_back(pending.back().second);
+        pending.pop_back();
+        values.push_back(node->value());
+
+        const typename DirectedRootedTree<T>::node_children_t& children = node->children();
+        for (auto iter = children.rbegin(); iter != children.rend(); ++iter)
+        {
+            pending.emplace_back(iter->get(), index);
+        }
+    }
+    *this = from_preorder(values, parents);
+}
+
+template <typename T>
+DirectedRootedTree<T> PersistentDirectedRootedTree<T>::to_tree() const
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    DirectedRootedTree<T> tree(m_root->value());
+    std::vector< std::pair<const Node*, TreeNode*> > pending(1, std::make_pair(root(), tree.root()));
+    while (!pending.empty())
+    {
+        const Node* node = pending.back().first;
+        TreeNode* tree_node = pending.back().second;
+        pending.pop_back();
+        for (const node_ptr_t& child : node->children())
+        {
+            pending.emplace_back(child.get(), tree.add_child(tree_node, child->value()));
+        }
+    }
+    return tree;
+}
+
+template <typename T>
+const typename PersistentDirectedRootedTree<T>::Node* PersistentDirectedRootedTree<T>::root() const
+{
+    return m_root.get();
+}
+
+template <typename T>
+const typename PersistentDirectedRootedTree<T>::Node* PersistentDirectedRootedTree<T>::node(const node_path_t& path) const
+{
+    return path_nodes(path).back();
+}
+
+template <typename T>
+size_t PersistentDirectedRootedTree<T>::size() const
+{
+    return m_size;
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T> PersistentDirectedRootedTree<T>::add_child(const node_path_t& parent, const T& value) const
+{
+    const std::vector<const Node*> nodes = path_nodes(parent);
+    const Node* parent_node = nodes.back();
+
+    node_children_t children;
+    children.reserve(parent_node->children().size() + 1);
+    children.insert(children.end(), parent_node->children().begin(), parent_node->children().end());
+    children.push_back(make_node(value, node_children_t()));
+    return PersistentDirectedRootedTree(replace_node(nodes, parent, parent.size(),
+                                                     make_node(parent_node->value(), std::move(children))),
+                                        m_size + 1);
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T> PersistentDirectedRootedTree<T>::remove_node(const node_path_t& node) const
+{
+    if (node.empty())
+    {
+        throw std::logic_error("Root cannot be removed");
+    }
+
+    const std::vector<const Node*> nodes = path_nodes(node);
+    const Node* removed_node = nodes.back();
+    const Node* parent_node = nodes[nodes.size() - 2];
+    const node_children_t& siblings = parent_node->children();
+    const size_t position = node.back();
+
+    node_children_t children;
+    children.reserve(siblings.size() - 1 + removed_node->children().size());
+    children.insert(children.end(), siblings.begin(), siblings.begin() + position);
+    children.insert(children.end(), removed_node->children().begin(), removed_node->children().end());
+    children.insert(children.end(), siblings.begin() + position + 1, siblings.end());
+    return PersistentDirectedRootedTree(replace_node(nodes, node, node.size() - 1,
+                                                     make_node(parent_node->value(), std::move(children))),
+                                        m_size - 1);
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T> PersistentDirectedRootedTree<T>::set_value(const node_path_t& node, const T& value) const
+{
+    const std::vector<const Node*> nodes = path_nodes(node);
+    node_children_t children = nodes.back()->children();
+    return PersistentDirectedRootedTree(replace_node(nodes, node, node.size(), make_node(value, std::move(children))),
+                                        m_size);
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T>::PersistentDirectedRootedTree(node_ptr_t root, size_t size)
+    : m_root(std::move(root)),
+      m_size(size)
+{
+
+}
+
+template <typename T>
+std::vector<const typename PersistentDirectedRootedTree<T>::Node*>
+PersistentDirectedRootedTree<T>::path_nodes(const node_path_t& path) const
+{
+    std::vector<const Node*> nodes;
+    nodes.reserve(path.size() + 1);
+    nodes.push_back(root());
+    for (size_t index : path)
+    {
+        const node_children_t& children = nodes.back()->children();
+        if (index >= children.size())
+        {
+            throw std::out_of_range("Path does not point to any node");
+        }
+        nodes.push_back(children[index].get());
+    }
+    return nodes;
+}
+
+template <typename T>
+typename PersistentDirectedRootedTree<T>::node_ptr_t
+PersistentDirectedRootedTree<T>::replace_node(const std::vector<const Node*>& nodes, const node_path_t& path,
+                                              size_t depth, node_ptr_t replacement) const
+{
+    for (size_t i = depth; i-- != 0; )
+    {
+        node_children_t children = nodes[i]->children();
+        children[path[i]] = std::move(replacement);
+        replacement = make_node(nodes[i]->value(), std::move(children));
+    }
+    return replacement;
+}
+
+template <typename T>
+typename PersistentDirectedRootedTree<T>::node_ptr_t
+PersistentDirectedRootedTree<T>::make_node(const T& value, node_children_t&& children)
+{
+    // Not const, so that the destructor of the parent may empty it, see ~Node
+    return std::make_shared<Node>(value, std::move(children));
+}
+
+#endif // PERSISTENTDIRECTEDROOTEDTREEIMPL_H
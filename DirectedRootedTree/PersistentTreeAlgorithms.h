@@ -0,0 +1,21 @@
+#ifndef PERSISTENTTREEALGORITHMS_H
+#define PERSISTENTTREEALGORITHMS_H
+
+#include "PersistentDirectedRootedTree.h"
+#include "TreeAlgorithms.h"
+
+namespace tree_algorithms
+{
+
+// Same columns as for the DirectedRootedTree with the same shape and values
+template <typename T>
+parallel_sequencing_t<T> lower_parallel_sequencing(const PersistentDirectedRootedTree<T>& tree);
+
+template <typename T>
+parallel_sequencing_t<T> upper_parallel_sequencing(const PersistentDirectedRootedTree<T>& tree);
+
+}
+
+#include "PersistentTreeAlgorithmsImpl.h"
+
+#endif // PERSISTENTTREEALGORITHMS_H
@@ -0,0 +1,86 @@
+#ifndef PERSISTENTTREEALGORITHMSIMPL_H
+#define PERSISTENTTREEALGORITHMSIMPL_H
+
+#include "PersistentTreeAlgorithms.h"
+
+#include <algorithm>
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::lower_parallel_sequencing(const PersistentDirectedRootedTree<T>& tree)
+{
+    typedef typename PersistentDirectedRootedTree<T>::Node Node;
+
+    parallel_sequencing_t<T> parallel_sequencing;
+
+    std::vector<const Node*> level(1, tree.root());
+    std::vector<const Node*> next_level;
+    while (true)
+    {
+        next_level.clear();
+        for (const Node* node : level)
+        {
+            for (const typename PersistentDirectedRootedTree<T>::node_ptr_t& child : node->children())
+            {
+                next_level.push_back(child.get());
+            }
+        }
+        if (next_level.empty())
+        {
+            break;
+        }
+        level.swap(next_level);
+
+        parallel_sequencing.emplace_back();
+        std::vector<T>& column = parallel_sequencing.back();
+        column.reserve(level.size());
+        for (const Node* node : level)
+        {
+            column.push_back(node->value());
+        }
+    }
+
+    return parallel_sequencing;
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::upper_parallel_sequencing(const PersistentDirectedRootedTree<T>& tree)
+{
+    typedef typename PersistentDirectedRootedTree<T>::Node Node;
+
+    parallel_sequencing_t<T> parallel_sequencing;
+
+    // Nodes with the index of their next child to visit, see the DirectedRootedTree overload for the heights
+    std::vector< std::pair<const Node*, size_t> > pending(1, std::make_pair(tree.root(), size_t(0)));
+    std::vector<size_t> heights;
+    while (pending.size() > 1 || pending.back().second != tree.root()->children().size())
+    {
+        const Node* node = pending.back().first;
+        const size_t next_child = pending.back().second;
+        if (next_child != node->children().size())
+        {
+            ++pending.back().second;
+            pending.emplace_back(node->children()[next_child].get(), size_t(0));
+            continue;
+        }
+        pending.pop_back();
+
+        const size_t children_count = node->children().size();
+        size_t height = 0;
+        for (size_t i = heights.size() - children_count; i != heights.size(); ++i)
+        {
+            height = std::max(height, heights[i] + 1);
+        }
+        heights.resize(heights.size() - children_count);
+        heights.push_back(height);
+
+        if (height >= parallel_sequencing.size())
+        {
+            parallel_sequencing.resize(height + 1);
+        }
+        parallel_sequencing[height].push_back(node->value());
+    }
+
+    return parallel_sequencing;
+}
+
+#endif // PERSISTENTTREEALGORITHMSIMPL_H
@@ -0,0 +1,127 @@
+#ifndef PUBLISHEDTREE_H
+#define PUBLISHEDTREE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "CacheLineAligned.h"
+#include "PersistentDirectedRootedTree.h"
+
+// Versions of a tree published by one writer to any number of concurrent readers.
+// A reader gets a consistent version without locks or waiting, the writer never waits for the readers.
+// Replaced versions are reclaimed by epochs: a version retired in epoch E is released once every reader
+// that entered in epoch E or earlier has left. Nodes shared with newer versions stay alive through them.
+template <typename T>
+class PublishedTree
+{
+    struct ReaderSlot;
+
+public:
+    class Reader;
+
+    // Keeps a published version alive while it exists
+    class ReadGuard
+    {
+        friend class Reader;
+
+    public:
+        ReadGuard(ReadGuard&& other);
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+        const PersistentDirectedRootedTree<T>& tree() const;
+        const PersistentDirectedRootedTree<T>* operator->() const;
+
+    private:
+        ReadGuard(Reader* reader, const PersistentDirectedRootedTree<T>* tree);
+
+    private:
+        Reader* m_reader;
+        const PersistentDirectedRootedTree<T>* m_tree;
+    };
+
+    // Registration of a reading thread, a reader must be used by one thread at a time.
+    // Guards of the same reader may be nested.
+    class Reader
+    {
+        friend class ReadGuard;
+
+    public:
+        explicit Reader(PublishedTree& published_tree);
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        ReadGuard read();
+
+    private:
+        void leave();
+
+    private:
+        PublishedTree& m_published_tree;
+        ReaderSlot* m_slot;
+        size_t m_depth;
+    };
+
+public:
+    explicit PublishedTree(const PersistentDirectedRootedTree<T>& tree = PersistentDirectedRootedTree<T>());
+    // All readers must be destroyed before
+    ~PublishedTree();
+
+    PublishedTree(const PublishedTree&) = delete;
+    PublishedTree& operator=(const PublishedTree&) = delete;
+
+    // Version seen by the writer, the last published one
+    PersistentDirectedRootedTree<T> current() const;
+
+    void publish(const PersistentDirectedRootedTree<T>& tree);
+    // The tree is converted, which costs all of its nodes
+    void publish(const DirectedRootedTree<T>& tree);
+
+    // Releases the retired versions which no reader can see, returns the number of the remaining ones
+    size_t reclaim();
+
+    size_t retired_count() const;
+    uint64_t epoch() const;
+
+private:
+    struct RetiredVersion
+    {
+        std::unique_ptr< const PersistentDirectedRootedTree<T> > tree;
+        uint64_t epoch;     /*!< Epoch of the writer when the version was replaced */
+    };
+
+    // Epoch of the reader or idle, alone in a cache line so readers don't slow each other down
+    struct alignas(CacheLineAligned::cache_line_size) ReaderSlot : CacheLineAligned
+    {
+        std::atomic<uint64_t> epoch;
+    };
+
+    static const uint64_t idle_epoch = UINT64_MAX;
+
+    ReaderSlot* register_reader();
+    void unregister_reader(ReaderSlot* slot);
+    uint64_t min_reader_epoch() const;
+
+private:
+    std::atomic<const PersistentDirectedRootedTree<T>*> m_published;
+    std::atomic<uint64_t> m_epoch;
+
+    mutable std::mutex m_writer_mutex;
+    std::vector<RetiredVersion> m_retired;
+
+    mutable std::mutex m_readers_mutex;
+    std::vector< std::unique_ptr<ReaderSlot> > m_reader_slots;
+    std::vector<ReaderSlot*> m_free_slots;
+};
+
+#include "PublishedTreeImpl.h"
+
+#endif // PUBLISHEDTREE_H
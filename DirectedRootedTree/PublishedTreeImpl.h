@@ -0,0 +1,198 @@
+#ifndef PUBLISHEDTREEIMPL_H
+#define PUBLISHEDTREEIMPL_H
+
+#include "PublishedTree.h"
+
+#include <algorithm>
+#include <iterator>
+
+template <typename T>
+const uint64_t PublishedTree<T>::idle_epoch;
+
+template <typename T>
+PublishedTree<T>::ReadGuard::ReadGuard(ReadGuard&& other)
+    : m_reader(other.m_reader),
+      m_tree(other.m_tree)
+{
+    other.m_reader = nullptr;
+    other.m_tree = nullptr;
+}
+
+template <typename T>
+PublishedTree<T>::ReadGuard::~ReadGuard()
+{
+    if (m_reader)
+    {
+        m_reader->leave();
+    }
+}
+
+template <typename T>
+const PersistentDirectedRootedTree<T>& PublishedTree<T>::ReadGuard::tree() const
+{
+    return *m_tree;
+}
+
+template <typename T>
+const PersistentDirectedRootedTree<T>* PublishedTree<T>::ReadGuard::operator->() const
+{
+    return m_tree;
+}
+
+template <typename T>
+PublishedTree<T>::ReadGuard::ReadGuard(Reader* reader, const PersistentDirectedRootedTree<T>* tree)
+    : m_reader(reader),
+      m_tree(tree)
+{
+
+}
+
+template <typename T>
+PublishedTree<T>::Reader::Reader(PublishedTree& published_tree)
+    : m_published_tree(published_tree),
+      m_slot(published_tree.register_reader()),
+      m_depth(0)
+{
+
+}
+
+template <typename T>
+PublishedTree<T>::Reader::~Reader()
+{
+    m_published_tree.unregister_reader(m_slot);
+}
+
+template <typename T>
+typename PublishedTree<T>::ReadGuard PublishedTree<T>::Reader::read()
+{
+    if (m_depth++ == 0)
+    {
+        // The epoch must be visible to the writer before the version is loaded:
+        // a version retired later is then kept for this reader
+        m_slot->epoch.store(m_published_tree.m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+    return ReadGuard(this, m_published_tree.m_published.load(std::memory_order_seq_cst));
+}
+
+template <typename T>
+void PublishedTree<T>::Reader::leave()
+{
+    if (--m_depth == 0)
+    {
+        m_slot->epoch.store(idle_epoch, std::memory_order_release);
+    }
+}
+
+template <typename T>
+PublishedTree<T>::PublishedTree(const PersistentDirectedRootedTree<T>& tree)
+    : m_published(new PersistentDirectedRootedTree<T>(tree)),
+      m_epoch(0)
+{
+
+}
+
+template <typename T>
+PublishedTree<T>::~PublishedTree()
+{
+    delete m_published.load();
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T> PublishedTree<T>::current() const
+{
+    std::lock_guard<std::mutex> lock(m_writer_mutex);
+    return *m_published.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void PublishedTree<T>::publish(const PersistentDirectedRootedTree<T>& tree)
+{
+    std::unique_ptr< const PersistentDirectedRootedTree<T> > published(new PersistentDirectedRootedTree<T>(tree));
+    {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        RetiredVersion retired;
+        retired.tree.reset(m_published.exchange(published.release(), std::memory_order_seq_cst));
+        retired.epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        m_retired.push_back(std::move(retired));
+    }
+    reclaim();
+}
+
+template <typename T>
+void PublishedTree<T>::publish(const DirectedRootedTree<T>& tree)
+{
+    publish(PersistentDirectedRootedTree<T>(tree));
+}
+
+template <typename T>
+size_t PublishedTree<T>::reclaim()
+{
+    std::vector<RetiredVersion> released;
+    size_t remaining_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        // A reader in epoch E may have loaded any version retired in E or later
+        const uint64_t min_epoch = min_reader_epoch();
+        typename std::vector<RetiredVersion>::iterator kept = std::stable_partition(
+                    m_retired.begin(), m_retired.end(),
+                    [min_epoch](const RetiredVersion& retired) -> bool
+        {
+            return retired.epoch >= min_epoch;
+        });
+        std::move(kept, m_retired.end(), std::back_inserter(released));
+        m_retired.erase(kept, m_retired.end());
+        remaining_count = m_retired.size();
+    }
+    // Released versions are destroyed outside of the lock
+    return remaining_count;
+}
+
+template <typename T>
+size_t PublishedTree<T>::retired_count() const
+{
+    std::lock_guard<std::mutex> lock(m_writer_mutex);
+    return m_retired.size();
+}
+
+template <typename T>
+uint64_t PublishedTree<T>::epoch() const
+{
+    return m_epoch.load();
+}
+
+template <typename T>
+typename PublishedTree<T>::ReaderSlot* PublishedTree<T>::register_reader()
+{
+    std::lock_guard<std::mutex> lock(m_readers_mutex);
+    if (m_free_slots.empty())
+    {
+        m_reader_slots.emplace_back(new ReaderSlot());
+        m_free_slots.push_back(m_reader_slots.back().get());
+        m_free_slots.back()->epoch.store(idle_epoch);
+    }
+    ReaderSlot* slot = m_free_slots.back();
+    m_free_slots.pop_back();
+    return slot;
+}
+
+template <typename T>
+void PublishedTree<T>::unregister_reader(ReaderSlot* slot)
+{
+    std::lock_guard<std::mutex> lock(m_readers_mutex);
+    slot->epoch.store(idle_epoch);
+    m_free_slots.push_back(slot);
+}
+
+template <typename T>
+uint64_t PublishedTree<T>::min_reader_epoch() const
+{
+    std::lock_guard<std::mutex> lock(m_readers_mutex);
+    uint64_t min_epoch = idle_epoch;
+    for (const std::unique_ptr<ReaderSlot>& slot : m_reader_slots)
+    {
+        min_epoch = std::min(min_epoch, slot->epoch.load(std::memory_order_seq_cst));
+    }
+    return min_epoch;
+}
+
+#endif // PUBLISHEDTREEIMPL_H
@@ -0,0 +1,91 @@
+#ifndef SEQUENCINGCACHE_H
+#define SEQUENCINGCACHE_H
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "TreeAlgorithms.h"
+
+namespace tree_algorithms
+{
+
+// Bounded LRU cache of the sequencings of trees with the same shape and values.
+// Trees with structural hashing enabled are looked up by their hasher and root hash without hashing any value,
+// other trees by a hash of their values and shape in preorder. On a hash match the tree is compared with
+// the cached one, so a collision or a stale hash is only a miss.
+// Results are shared, not copied.
+// The cache can be used from several threads, sequencings are computed outside of the lock.
+template <typename T>
+class SequencingCache
+{
+public:
+    typedef std::shared_ptr<const parallel_sequencing_t<T> > sequencing_ptr_t;
+    typedef std::function<size_t(const T&)> value_hasher_t;
+
+public:
+    explicit SequencingCache(size_t capacity, value_hasher_t value_hasher = std::hash<T>());
+
+    SequencingCache(const SequencingCache&) = delete;
+    SequencingCache& operator=(const SequencingCache&) = delete;
+
+    sequencing_ptr_t lower_parallel_sequencing(const DirectedRootedTree<T>& tree);
+    sequencing_ptr_t upper_parallel_sequencing(const DirectedRootedTree<T>& tree);
+
+    size_t size() const;
+    size_t capacity() const;
+
+    size_t hits() const;
+    size_t misses() const;
+    size_t evictions() const;
+
+    void clear();
+
+private:
+    struct Entry
+    {
+        size_t hash;
+        std::shared_ptr<const value_hasher_t> tree_hasher;  /*!< Hasher of the structural hash, empty for the preorder hash */
+        std::vector<size_t> children_counts;    /*!< Shape of the cached tree in preorder */
+        std::vector<T> values;                  /*!< Values of the cached tree in preorder */
+        sequencing_ptr_t lower;
+        sequencing_ptr_t upper;
+    };
+
+    typedef std::list<Entry> entries_t;     // The most recently used entry is the first one
+    typedef std::pair<const void*, size_t> index_key_t;     // Hasher and hash of the tree
+
+    struct IndexKeyHash
+    {
+        size_t operator()(const index_key_t& key) const;
+    };
+
+    typedef std::unordered_map<index_key_t, typename entries_t::iterator, IndexKeyHash> index_t;
+
+    sequencing_ptr_t find_or_compute(const DirectedRootedTree<T>& tree, bool lower);
+    void store(const DirectedRootedTree<T>& tree, size_t hash, const std::shared_ptr<const value_hasher_t>& tree_hasher,
+               bool lower, const sequencing_ptr_t& sequencing);
+    static index_key_t index_key(const std::shared_ptr<const value_hasher_t>& tree_hasher, size_t hash);
+
+    size_t tree_hash(const DirectedRootedTree<T>& tree) const;
+    static bool matches(const Entry& entry, const DirectedRootedTree<T>& tree,
+                        const std::shared_ptr<const value_hasher_t>& tree_hasher);
+
+private:
+    mutable std::mutex m_mutex;
+    size_t m_capacity;
+    value_hasher_t m_value_hasher;
+    entries_t m_entries;
+    index_t m_index;
+    size_t m_hits;
+    size_t m_misses;
+    size_t m_evictions;
+};
+
+}
+
+#include "SequencingCacheImpl.h"
+
+#endif // SEQUENCINGCACHE_H
@@ -0,0 +1,217 @@
+#ifndef SEQUENCINGCACHEIMPL_H
+#define SEQUENCINGCACHEIMPL_H
+
+#include "SequencingCache.h"
+
+template <typename T>
+tree_algorithms::SequencingCache<T>::SequencingCache(size_t capacity, value_hasher_t value_hasher)
+    : m_capacity(capacity),
+      m_value_hasher(std::move(value_hasher)),
+      m_hits(0),
+      m_misses(0),
+      m_evictions(0)
+{
+
+}
+
+template <typename T>
+typename tree_algorithms::SequencingCache<T>::sequencing_ptr_t
+tree_algorithms::SequencingCache<T>::lower_parallel_sequencing(const DirectedRootedTree<T>& tree)
+{
+    return find_or_compute(tree, true);
+}
+
+template <typename T>
+typename tree_algorithms::SequencingCache<T>::sequencing_ptr_t
+tree_algorithms::SequencingCache<T>::upper_parallel_sequencing(const DirectedRootedTree<T>& tree)
+{
+    return find_or_compute(tree, false);
+}
+
+template <typename T>
+size_t tree_algorithms::SequencingCache<T>::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+template <typename T>
+size_t tree_algorithms::SequencingCache<T>::capacity() const
+{
+    return m_capacity;
+}
+
+template <typename T>
+size_t tree_algorithms::SequencingCache<T>::hits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+template <typename T>
+size_t tree_algorithms::SequencingCache<T>::misses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+template <typename T>
+size_t tree_algorithms::SequencingCache<T>::evictions() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_evictions;
+}
+
+template <typename T>
+void tree_algorithms::SequencingCache<T>::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_entries.clear();
+}
+
+template <typename T>
+typename tree_algorithms::SequencingCache<T>::sequencing_ptr_t
+tree_algorithms::SequencingCache<T>::find_or_compute(const DirectedRootedTree<T>& tree, bool lower)
+{
+    const std::shared_ptr<const value_hasher_t> tree_hasher = tree.structural_hasher();
+    const size_t hash = tree_hasher ? tree.root()->structural_hash() : tree_hash(tree);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        typename index_t::iterator found = m_index.find(index_key(tree_hasher, hash));
+        if (found != m_index.end() && matches(*found->second, tree, tree_hasher))
+        {
+            const sequencing_ptr_t& sequencing = lower ? found->second->lower : found->second->upper;
+            if (sequencing)
+            {
+                ++m_hits;
+                m_entries.splice(m_entries.begin(), m_entries, found->second);
+                return sequencing;
+            }
+        }
+        ++m_misses;
+    }
+
+    sequencing_ptr_t sequencing = std::make_shared<const parallel_sequencing_t<T> >(
+                lower ? tree_algorithms::lower_parallel_sequencing(tree) : tree_algorithms::upper_parallel_sequencing(tree));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    store(tree, hash, tree_hasher, lower, sequencing);
+    return sequencing;
+}
+
+template <typename T>
+void tree_algorithms::SequencingCache<T>::store(const DirectedRootedTree<T>& tree, size_t hash,
+                                                const std::shared_ptr<const value_hasher_t>& tree_hasher,
+                                                bool lower, const sequencing_ptr_t& sequencing)
+{
+    if (m_capacity == 0)
+    {
+        return;
+    }
+
+    // Another thread could have stored the same tree meanwhile, a colliding tree is replaced
+    const index_key_t key = index_key(tree_hasher, hash);
+    typename index_t::iterator found = m_index.find(key);
+    if (found != m_index.end())
+    {
+        if (!matches(*found->second, tree, tree_hasher))
+        {
+            m_entries.erase(found->second);
+            m_index.erase(found);
+            found = m_index.end();
+        }
+        else
+        {
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+        }
+    }
+    if (found == m_index.end())
+    {
+        Entry entry;
+        entry.hash = hash;
+        entry.tree_hasher = tree_hasher;
+        entry.children_counts.reserve(tree.size());
+        entry.values.reserve(tree.size());
+        for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+        {
+            entry.children_counts.push_back(iter.current_node()->children().size());
+            entry.values.push_back(*iter);
+        }
+        m_entries.push_front(std::move(entry));
+        found = m_index.emplace(key, m_entries.begin()).first;
+    }
+
+    sequencing_ptr_t& cached = lower ? found->second->lower : found->second->upper;
+    if (!cached)
+    {
+        cached = sequencing;
+    }
+
+    if (m_entries.size() > m_capacity)
+    {
+        m_index.erase(index_key(m_entries.back().tree_hasher, m_entries.back().hash));
+        m_entries.pop_back();
+        ++m_evictions;
+    }
+}
+
+template <typename T>
+size_t tree_algorithms::SequencingCache<T>::IndexKeyHash::operator()(const index_key_t& key) const
+{
+    return std::hash<const void*>()(key.first) ^ key.second;
+}
+
+template <typename T>
+typename tree_algorithms::SequencingCache<T>::index_key_t
+tree_algorithms::SequencingCache<T>::index_key(const std::shared_ptr<const value_hasher_t>& tree_hasher, size_t hash)
+{
+    // A cached entry holds its hasher, so the address of an indexed hasher is not reused.
+    // Trees hashed by the default hasher share one key, as in DirectedRootedTree::same_hashers
+    static const char default_hasher = 0;
+    if (!tree_hasher)
+    {
+        return index_key_t(nullptr, hash);
+    }
+    if (tree_hasher->template target< std::hash<T> >())
+    {
+        return index_key_t(&default_hasher, hash);
+    }
+    return index_key_t(tree_hasher.get(), hash);
+}
+
+template <typename T>
+size_t tree_algorithms::SequencingCache<T>::tree_hash(const DirectedRootedTree<T>& tree) const
+{
+    size_t hash = tree.size();
+    for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+    {
+        const size_t node_hash = m_value_hasher(*iter) * 31 + iter.current_node()->children().size();
+        hash ^= node_hash + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+template <typename T>
+bool tree_algorithms::SequencingCache<T>::matches(const Entry& entry, const DirectedRootedTree<T>& tree,
+                                                  const std::shared_ptr<const value_hasher_t>& tree_hasher)
+{
+    if (entry.values.size() != tree.size())
+    {
+        return false;
+    }
+    if (tree_hasher ? !DirectedRootedTree<T>::same_hashers(entry.tree_hasher, tree_hasher) : bool(entry.tree_hasher))
+    {
+        return false;
+    }
+    size_t index = 0;
+    for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter, ++index)
+    {
+        if (entry.children_counts[index] != iter.current_node()->children().size() || !(entry.values[index] == *iter))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // SEQUENCINGCACHEIMPL_H
@@ -0,0 +1,248 @@
+#ifndef TRAVERSALITERATORSIMPL_H
+#define TRAVERSALITERATORSIMPL_H
+
+#include "DirectedRootedTree.h"
+
+#include <stdexcept>
+
+template <typename T>
+DirectedRootedTree<T>::ConstIterator::ConstIterator(const TreeNode* current_node)
+    : m_current_node(current_node)
+{
+
+}
+
+template <typename T>
+DirectedRootedTree<T>::ConstIterator::ConstIterator(const Iterator& iterator)
+    : m_current_node(iterator.m_current_node)
+{
+
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::ConstIterator& DirectedRootedTree<T>::ConstIterator::operator++()
+{
+    if (!m_current_node)
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    m_current_node = next_preorder(m_current_node);
+    return *this;
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::ConstIterator DirectedRootedTree<T>::ConstIterator::operator++(int)
+{
+    ConstIterator temp(*this);
+    operator++();
+    return temp;
+}
+
+template <typename T>
+const T& DirectedRootedTree<T>::ConstIterator::operator*() const
+{
+    if (!m_current_node)
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    return m_current_node->value();
+}
+
+template <typename T>
+const T* DirectedRootedTree<T>::ConstIterator::operator->() const
+{
+    return &operator*();
+}
+
+template <typename T>
+const typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::ConstIterator::current_node() const
+{
+    return m_current_node;
+}
+
+template <typename T>
+DirectedRootedTree<T>::PostorderIterator::PostorderIterator(const TreeNode* current_node)
+    : m_current_node(current_node)
+{
+
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::PostorderIterator& DirectedRootedTree<T>::PostorderIterator::operator++()
+{
+    if (!m_current_node)
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    m_current_node = next_postorder(m_current_node);
+    return *this;
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::PostorderIterator DirectedRootedTree<T>::PostorderIterator::operator++(int)
+{
+    PostorderIterator temp(*this);
+    operator++();
+    return temp;
+}
+
+template <typename T>
+const T& DirectedRootedTree<T>::PostorderIterator::operator*() const
+{
+    if (!m_current_node)
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    return m_current_node->value();
+}
+
+template <typename T>
+const T* DirectedRootedTree<T>::PostorderIterator::operator->() const
+{
+    return &operator*();
+}
+
+template <typename T>
+const typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::PostorderIterator::current_node() const
+{
+    return m_current_node;
+}
+
+template <typename T>
+DirectedRootedTree<T>::BreadthFirstIterator::BreadthFirstIterator(const TreeNode* current_node)
+{
+    if (current_node)
+    {
+        m_queue.push_back(current_node);
+    }
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::BreadthFirstIterator& DirectedRootedTree<T>::BreadthFirstIterator::operator++()
+{
+    if (m_queue.empty())
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    for (const node_ptr_t& child : m_queue.front()->children())
+    {
+        m_queue.push_back(child.get());
+    }
+    m_queue.pop_front();
+    return *this;
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::BreadthFirstIterator DirectedRootedTree<T>::BreadthFirstIterator::operator++(int)
+{
+    BreadthFirstIterator temp(*this);
+    operator++();
+    return temp;
+}
+
+template <typename T>
+const T& DirectedRootedTree<T>::BreadthFirstIterator::operator*() const
+{
+    if (m_queue.empty())
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    return m_queue.front()->value();
+}
+
+template <typename T>
+const T* DirectedRootedTree<T>::BreadthFirstIterator::operator->() const
+{
+    return &operator*();
+}
+
+template <typename T>
+const typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::BreadthFirstIterator::current_node() const
+{
+    return m_queue.empty() ? nullptr : m_queue.front();
+}
+
+template <typename T>
+DirectedRootedTree<T>::LevelIterator::LevelIterator(const TreeNode* root)
+    : m_depth(0)
+{
+    if (root)
+    {
+        m_level.push_back(root);
+    }
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::LevelIterator& DirectedRootedTree<T>::LevelIterator::operator++()
+{
+    if (m_level.empty())
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    m_next_level.clear();
+    for (const TreeNode* node : m_level)
+    {
+        for (const node_ptr_t& child : node->children())
+        {
+            m_next_level.push_back(child.get());
+        }
+    }
+    m_level.swap(m_next_level);
+    ++m_depth;
+    return *this;
+}
+
+template <typename T>
+typename DirectedRootedTree<T>::LevelIterator DirectedRootedTree<T>::LevelIterator::operator++(int)
+{
+    LevelIterator temp(*this);
+    operator++();
+    return temp;
+}
+
+template <typename T>
+const typename DirectedRootedTree<T>::level_nodes_t& DirectedRootedTree<T>::LevelIterator::operator*() const
+{
+    if (m_level.empty())
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    return m_level;
+}
+
+template <typename T>
+const typename DirectedRootedTree<T>::level_nodes_t* DirectedRootedTree<T>::LevelIterator::operator->() const
+{
+    return &operator*();
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::LevelIterator::depth() const
+{
+    return m_depth;
+}
+
+template <typename T>
+template <typename TIterator>
+DirectedRootedTree<T>::Range<TIterator>::Range(TIterator begin, TIterator end)
+    : m_begin(begin),
+      m_end(end)
+{
+
+}
+
+template <typename T>
+template <typename TIterator>
+TIterator DirectedRootedTree<T>::Range<TIterator>::begin() const
+{
+    return m_begin;
+}
+
+template <typename T>
+template <typename TIterator>
+TIterator DirectedRootedTree<T>::Range<TIterator>::end() const
+{
+    return m_end;
+}
+
+#endif // TRAVERSALITERATORSIMPL_H
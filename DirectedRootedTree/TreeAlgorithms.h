@@ -1,6 +1,8 @@
 #ifndef TREEALGORITHMS_H
 #define TREEALGORITHMS_H
 
+#include <iterator>
+#include <utility>
 #include <vector>
 
 #include "DirectedRootedTree.h"
@@ -12,22 +14,187 @@ template <typename T>
 std::vector<T> top_leaves(const DirectedRootedTree<T>& tree,
                           std::vector<typename DirectedRootedTree<T>::TreeNode*>* top_nodes = nullptr);
 
-// TODO: make tree a const reference by implementing const DirectedRootedTree<T>::Iterator
 template <typename T>
-std::vector<T> bottom_leaves(DirectedRootedTree<T>& tree
-                             /*!< Non-const because const Iterator is not implemented yet */,
+std::vector<T> bottom_leaves(const DirectedRootedTree<T>& tree,
                              std::vector<typename DirectedRootedTree<T>::TreeNode*>* bottom_nodes = nullptr);
 
 template <typename T>
 using parallel_sequencing_t = std::vector< std::vector<T> >;
 
-// TODO: Copy tree instead of changing the original one
+// Groups the nodes by their depth, the root is not included
 template <typename T>
-parallel_sequencing_t<T> lower_parallel_sequencing(DirectedRootedTree<T>& tree);
+parallel_sequencing_t<T> lower_parallel_sequencing(const DirectedRootedTree<T>& tree);
 
-// TODO: Copy tree instead of changing the original one
+// Columns of lower_parallel_sequencing produced one at a time, a column is computed when the iteration reaches it.
+// Only the current level is kept in memory.
 template <typename T>
-parallel_sequencing_t<T> upper_parallel_sequencing(DirectedRootedTree<T>& tree);
+class LowerSequencingGenerator
+{
+public:
+    class Iterator : public std::iterator<std::input_iterator_tag, std::vector<T>, size_t,
+                                          const std::vector<T>*, const std::vector<T>&>
+    {
+        friend bool operator==(const Iterator& left, const Iterator& right)
+        {
+            return left.at_end() == right.at_end();
+        }
+
+        friend bool operator!=(const Iterator& left, const Iterator& right)
+        {
+            return !(left == right);
+        }
+
+    public:
+        // Result of the postfix increment: all iterators share the current column of the generator,
+        // so the previous column is kept aside
+        class PreviousColumn
+        {
+        public:
+            explicit PreviousColumn(std::vector<T>&& column);
+
+            const std::vector<T>& operator*() const;
+            const std::vector<T>* operator->() const;
+
+        private:
+            std::vector<T> m_column;
+        };
+
+    public:
+        explicit Iterator(LowerSequencingGenerator* generator = nullptr);
+
+        Iterator& operator++();
+        PreviousColumn operator++(int);
+
+        const std::vector<T>& operator*() const;
+        const std::vector<T>* operator->() const;
+
+    private:
+        bool at_end() const;
+
+    private:
+        LowerSequencingGenerator* m_generator;
+    };
+
+public:
+    explicit LowerSequencingGenerator(const DirectedRootedTree<T>& tree);
+
+    Iterator begin();
+    Iterator end();
+
+    // Computes the next column, returns false when there are no more columns
+    bool next();
+    bool done() const;
+
+    const std::vector<T>& column() const;
+
+private:
+    typename DirectedRootedTree<T>::LevelIterator m_level;
+    std::vector<T> m_column;
+    bool m_started;
+};
+
+template <typename T>
+LowerSequencingGenerator<T> lazy_lower_parallel_sequencing(const DirectedRootedTree<T>& tree);
+
+// Groups the nodes by their height (distance to the deepest leaf below), the root is not included
+template <typename T>
+parallel_sequencing_t<T> upper_parallel_sequencing(const DirectedRootedTree<T>& tree);
+
+// Sequencing of tree nodes stored in a single buffer: levels go one after another,
+// level i occupies [level_offsets[i], level_offsets[i + 1]) of the buffer
+template <typename T>
+class NodeSequencing
+{
+public:
+    typedef const typename DirectedRootedTree<T>::TreeNode* node_t;
+    typedef typename std::vector<node_t>::const_iterator const_iterator;
+
+public:
+    NodeSequencing();
+    NodeSequencing(std::vector<node_t>&& nodes, std::vector<size_t>&& level_offsets);
+
+    size_t levels_count() const;
+    size_t level_size(size_t level) const;
+
+    const_iterator level_begin(size_t level) const;
+    const_iterator level_end(size_t level) const;
+
+    const std::vector<node_t>& nodes() const;
+    const std::vector<size_t>& level_offsets() const;
+
+    parallel_sequencing_t<T> values() const;
+
+private:
+    std::vector<node_t> m_nodes;
+    std::vector<size_t> m_level_offsets;
+};
+
+template <typename T>
+std::vector<const typename DirectedRootedTree<T>::TreeNode*> top_leaf_nodes(const DirectedRootedTree<T>& tree);
+
+template <typename T>
+std::vector<const typename DirectedRootedTree<T>::TreeNode*> bottom_leaf_nodes(const DirectedRootedTree<T>& tree);
+
+// Same levels as lower_parallel_sequencing without copying the values
+template <typename T>
+NodeSequencing<T> lower_node_sequencing(const DirectedRootedTree<T>& tree);
+
+// Same levels as upper_parallel_sequencing without copying the values
+template <typename T>
+NodeSequencing<T> upper_node_sequencing(const DirectedRootedTree<T>& tree);
+
+// Packs the nodes into stages of at most width nodes, every node is placed after all of its children
+// (same order as upper_parallel_sequencing). Uses Hu's algorithm, which gives the minimal number of stages:
+// ready nodes are taken deepest first. The order of the nodes inside of a stage is unspecified.
+template <typename T>
+NodeSequencing<T> upper_bounded_sequencing(const DirectedRootedTree<T>& tree, size_t width);
+
+// Same as upper_bounded_sequencing with the stages reversed, so every node is placed after its parent
+// (same order as lower_parallel_sequencing). The number of stages is minimal as well.
+template <typename T>
+NodeSequencing<T> lower_bounded_sequencing(const DirectedRootedTree<T>& tree, size_t width);
+
+// Parent index of the nodes whose parent is the root
+const size_t no_parent_index = static_cast<size_t>(-1);
+
+// Weighted start times of the nodes, every node starts after its parent is finished.
+// All arrays are indexed by the preorder number of a node, the root is not included.
+template <typename T>
+struct WeightedSchedule
+{
+    std::vector<const typename DirectedRootedTree<T>::TreeNode*> nodes;
+    std::vector<size_t> parents;            /*!< Index of the parent or no_parent_index */
+    std::vector<double> weights;
+    std::vector<double> earliest_starts;
+    std::vector<double> latest_starts;      /*!< Latest start that does not delay the whole schedule */
+    std::vector<size_t> critical_path;      /*!< Indices of the longest chain, from the top to a leaf */
+    double duration;                        /*!< Length of the critical path */
+};
+
+// Computes the schedule with one pass over the tree in preorder and one in reverse preorder,
+// weight is called once per node with its value and must return a non-negative duration
+template <typename T, typename TWeight>
+WeightedSchedule<T> weighted_schedule(const DirectedRootedTree<T>& tree, TWeight weight);
+
+// Pairs of nodes at the same positions of the trees whose values or children counts differ, in preorder.
+// Only the subtrees with different structural hashes are visited, so both trees must have hashing enabled
+// with the same hasher (std::logic_error otherwise); subtrees with equal hashes are taken as equal.
+template <typename T>
+std::vector< std::pair<const typename DirectedRootedTree<T>::TreeNode*, const typename DirectedRootedTree<T>::TreeNode*> >
+differing_nodes(const DirectedRootedTree<T>& left, const DirectedRootedTree<T>& right);
+
+// Range of columns a node can be moved between without breaking the order of the tree
+template <typename T>
+struct SlackWindow
+{
+    const typename DirectedRootedTree<T>::TreeNode* node;
+    size_t earliest_column;     /*!< Column of the node in lower_parallel_sequencing */
+    size_t latest_column;       /*!< Column of the node in reversed upper_parallel_sequencing */
+};
+
+// Slack windows of all nodes except the root, in preorder
+template <typename T>
+std::vector< SlackWindow<T> > slack_windows(const DirectedRootedTree<T>& tree);
 
 }
 
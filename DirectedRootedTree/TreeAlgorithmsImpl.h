@@ -5,7 +5,8 @@
 
 #include <algorithm>
 #include <iterator>
-#include <list>
+#include <set>
+#include <stdexcept>
 
 template <typename T>
 std::vector<T> tree_algorithms::top_leaves(const DirectedRootedTree<T>& tree,
@@ -16,7 +17,7 @@ std::vector<T> tree_algorithms::top_leaves(const DirectedRootedTree<T>& tree,
     const typename DirectedRootedTree<T>::node_children_t& children = tree.root()->children();
     leaves.reserve(children.size());
     std::transform(children.begin(), children.end(), std::back_inserter(leaves),
-                   [](const std::unique_ptr<typename DirectedRootedTree<T>::TreeNode>& child) -> T {
+                   [](const typename DirectedRootedTree<T>::node_ptr_t& child) -> T {
         return child->value();
     });
 
@@ -24,7 +25,7 @@ std::vector<T> tree_algorithms::top_leaves(const DirectedRootedTree<T>& tree,
     {
         top_nodes->reserve(children.size());
         std::transform(children.begin(), children.end(), std::back_inserter(*top_nodes),
-                       [](const std::unique_ptr<typename DirectedRootedTree<T>::TreeNode>& child) -> typename DirectedRootedTree<T>::TreeNode* {
+                       [](const typename DirectedRootedTree<T>::node_ptr_t& child) -> typename DirectedRootedTree<T>::TreeNode* {
             return child.get();
         });
     }
@@ -33,68 +34,690 @@ std::vector<T> tree_algorithms::top_leaves(const DirectedRootedTree<T>& tree,
 }
 
 template <typename T>
-std::vector<T> tree_algorithms::bottom_leaves(DirectedRootedTree<T>& tree,
+std::vector<T> tree_algorithms::bottom_leaves(const DirectedRootedTree<T>& tree,
                                               std::vector<typename DirectedRootedTree<T>::TreeNode*>* bottom_nodes)
 {
-    std::list<T> leaves;
-    std::list<typename DirectedRootedTree<T>::TreeNode*> nodes;
+    std::vector<T> leaves;
 
-    typename DirectedRootedTree<T>::Iterator iter = tree.begin();
-    while (iter != tree.end())
+    for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
     {
         if (iter.current_node()->children().empty())
         {
             leaves.push_back(*iter);
             if (bottom_nodes)
             {
-                nodes.push_back(iter.current_node());
+                // Same as top_leaves, nodes are handed out for modification by the caller
+                bottom_nodes->push_back(const_cast<typename DirectedRootedTree<T>::TreeNode*>(iter.current_node()));
             }
         }
-        ++iter;
     }
-    if (bottom_nodes)
+    return leaves;
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::lower_parallel_sequencing(const DirectedRootedTree<T>& tree)
+{
+    parallel_sequencing_t<T> parallel_sequencing;
+
+    typename DirectedRootedTree<T>::template Range<typename DirectedRootedTree<T>::LevelIterator> levels = tree.levels();
+    for (typename DirectedRootedTree<T>::LevelIterator level = ++levels.begin(); level != levels.end(); ++level)
+    {
+        parallel_sequencing.emplace_back();
+        std::vector<T>& column = parallel_sequencing.back();
+        column.reserve(level->size());
+        for (const typename DirectedRootedTree<T>::TreeNode* node : *level)
+        {
+            column.push_back(node->value());
+        }
+    }
+
+    return parallel_sequencing;
+}
+
+template <typename T>
+tree_algorithms::LowerSequencingGenerator<T>::Iterator::Iterator(LowerSequencingGenerator* generator)
+    : m_generator(generator)
+{
+
+}
+
+template <typename T>
+typename tree_algorithms::LowerSequencingGenerator<T>::Iterator& tree_algorithms::LowerSequencingGenerator<T>::Iterator::operator++()
+{
+    if (at_end())
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    m_generator->next();
+    return *this;
+}
+
+template <typename T>
+typename tree_algorithms::LowerSequencingGenerator<T>::Iterator::PreviousColumn
+tree_algorithms::LowerSequencingGenerator<T>::Iterator::operator++(int)
+{
+    if (at_end())
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    // The column is computed anew by next(), so it is moved out instead of copied
+    PreviousColumn previous(std::move(m_generator->m_column));
+    m_generator->next();
+    return previous;
+}
+
+template <typename T>
+const std::vector<T>& tree_algorithms::LowerSequencingGenerator<T>::Iterator::operator*() const
+{
+    if (at_end())
+    {
+        throw std::out_of_range("Iterator does not point to any element");
+    }
+    return m_generator->column();
+}
+
+template <typename T>
+const std::vector<T>* tree_algorithms::LowerSequencingGenerator<T>::Iterator::operator->() const
+{
+    return &operator*();
+}
+
+template <typename T>
+tree_algorithms::LowerSequencingGenerator<T>::Iterator::PreviousColumn::PreviousColumn(std::vector<T>&& column)
+    : m_column(std::move(column))
+{
+
+}
+
+template <typename T>
+const std::vector<T>& tree_algorithms::LowerSequencingGenerator<T>::Iterator::PreviousColumn::operator*() const
+{
+    return m_column;
+}
+
+template <typename T>
+const std::vector<T>* tree_algorithms::LowerSequencingGenerator<T>::Iterator::PreviousColumn::operator->() const
+{
+    return &m_column;
+}
+
+template <typename T>
+bool tree_algorithms::LowerSequencingGenerator<T>::Iterator::at_end() const
+{
+    return m_generator == nullptr || m_generator->done();
+}
+
+template <typename T>
+tree_algorithms::LowerSequencingGenerator<T>::LowerSequencingGenerator(const DirectedRootedTree<T>& tree)
+    : m_level(tree.levels().begin()),
+      m_started(false)
+{
+
+}
+
+template <typename T>
+typename tree_algorithms::LowerSequencingGenerator<T>::Iterator tree_algorithms::LowerSequencingGenerator<T>::begin()
+{
+    if (!m_started)
+    {
+        next();
+    }
+    return Iterator(this);
+}
+
+template <typename T>
+typename tree_algorithms::LowerSequencingGenerator<T>::Iterator tree_algorithms::LowerSequencingGenerator<T>::end()
+{
+    return Iterator();
+}
+
+template <typename T>
+bool tree_algorithms::LowerSequencingGenerator<T>::next()
+{
+    if (done())
+    {
+        return false;
+    }
+    // The first level holds the root, which is not a part of the sequencing
+    m_started = true;
+    ++m_level;
+    m_column.clear();
+    if (done())
+    {
+        return false;
+    }
+    m_column.reserve(m_level->size());
+    for (const typename DirectedRootedTree<T>::TreeNode* node : *m_level)
     {
-        bottom_nodes->assign(nodes.begin(), nodes.end());
+        m_column.push_back(node->value());
     }
-    return std::vector<T>(leaves.begin(), leaves.end());
+    return true;
 }
 
 template <typename T>
-tree_algorithms::parallel_sequencing_t<T> tree_algorithms::lower_parallel_sequencing(DirectedRootedTree<T>& tree)
+bool tree_algorithms::LowerSequencingGenerator<T>::done() const
+{
+    return m_level == typename DirectedRootedTree<T>::LevelIterator();
+}
+
+template <typename T>
+const std::vector<T>& tree_algorithms::LowerSequencingGenerator<T>::column() const
+{
+    return m_column;
+}
+
+template <typename T>
+tree_algorithms::LowerSequencingGenerator<T> tree_algorithms::lazy_lower_parallel_sequencing(const DirectedRootedTree<T>& tree)
+{
+    return LowerSequencingGenerator<T>(tree);
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::upper_parallel_sequencing(const DirectedRootedTree<T>& tree)
 {
     parallel_sequencing_t<T> parallel_sequencing;
 
-    while (!tree.root()->children().empty())
+    if (tree.node_metrics_enabled() && tree.root())
+    {
+        // Heights are kept by the nodes, so a preorder pass fills the columns in the same order
+        parallel_sequencing.resize(tree.root()->height());
+        for (typename DirectedRootedTree<T>::ConstIterator iter = ++tree.cbegin(); iter != tree.cend(); ++iter)
+        {
+            parallel_sequencing[iter.current_node()->height()].push_back(*iter);
+        }
+        return parallel_sequencing;
+    }
+
+    // Heights of the visited nodes whose parent is not visited yet.
+    // In postorder the heights of a node's children are on top when the node is visited.
+    std::vector<size_t> heights;
+
+    for (typename DirectedRootedTree<T>::PostorderIterator iter = tree.postorder().begin();
+         iter.current_node() != tree.root();
+         ++iter)
     {
-        std::vector<typename DirectedRootedTree<T>::TreeNode*> top_nodes;
-        parallel_sequencing.push_back(top_leaves(tree, &top_nodes));
+        const size_t children_count = iter.current_node()->children().size();
+        size_t height = 0;
+        for (size_t i = heights.size() - children_count; i != heights.size(); ++i)
+        {
+            height = std::max(height, heights[i] + 1);
+        }
+        heights.resize(heights.size() - children_count);
+        heights.push_back(height);
 
-        for (typename DirectedRootedTree<T>::TreeNode* child : top_nodes)
+        // Nodes of the same height are never ancestors of each other,
+        // so their postorder is the same as their preorder
+        if (height >= parallel_sequencing.size())
         {
-            tree.remove_node(child);
+            parallel_sequencing.resize(height + 1);
         }
+        parallel_sequencing[height].push_back(*iter);
     }
 
     return parallel_sequencing;
 }
 
 template <typename T>
-tree_algorithms::parallel_sequencing_t<T> tree_algorithms::upper_parallel_sequencing(DirectedRootedTree<T>& tree)
+tree_algorithms::NodeSequencing<T>::NodeSequencing()
+    : m_level_offsets(1, 0)
 {
-    parallel_sequencing_t<T> parallel_sequencing;
 
-    while (!tree.root()->children().empty())
+}
+
+template <typename T>
+tree_algorithms::NodeSequencing<T>::NodeSequencing(std::vector<node_t>&& nodes, std::vector<size_t>&& level_offsets)
+    : m_nodes(std::move(nodes)),
+      m_level_offsets(std::move(level_offsets))
+{
+
+}
+
+template <typename T>
+size_t tree_algorithms::NodeSequencing<T>::levels_count() const
+{
+    return m_level_offsets.size() - 1;
+}
+
+template <typename T>
+size_t tree_algorithms::NodeSequencing<T>::level_size(size_t level) const
+{
+    return m_level_offsets[level + 1] - m_level_offsets[level];
+}
+
+template <typename T>
+typename tree_algorithms::NodeSequencing<T>::const_iterator tree_algorithms::NodeSequencing<T>::level_begin(size_t level) const
+{
+    return m_nodes.begin() + m_level_offsets[level];
+}
+
+template <typename T>
+typename tree_algorithms::NodeSequencing<T>::const_iterator tree_algorithms::NodeSequencing<T>::level_end(size_t level) const
+{
+    return m_nodes.begin() + m_level_offsets[level + 1];
+}
+
+template <typename T>
+const std::vector<typename tree_algorithms::NodeSequencing<T>::node_t>& tree_algorithms::NodeSequencing<T>::nodes() const
+{
+    return m_nodes;
+}
+
+template <typename T>
+const std::vector<size_t>& tree_algorithms::NodeSequencing<T>::level_offsets() const
+{
+    return m_level_offsets;
+}
+
+template <typename T>
+tree_algorithms::parallel_sequencing_t<T> tree_algorithms::NodeSequencing<T>::values() const
+{
+    parallel_sequencing_t<T> parallel_sequencing(levels_count());
+    for (size_t level = 0; level != levels_count(); ++level)
     {
-        std::vector<typename DirectedRootedTree<T>::TreeNode*> bottom_nodes;
-        parallel_sequencing.push_back(bottom_leaves(tree, &bottom_nodes));
+        parallel_sequencing[level].reserve(level_size(level));
+        for (const_iterator iter = level_begin(level); iter != level_end(level); ++iter)
+        {
+            parallel_sequencing[level].push_back((*iter)->value());
+        }
+    }
+    return parallel_sequencing;
+}
 
-        for (typename DirectedRootedTree<T>::TreeNode* child : bottom_nodes)
+template <typename T>
+std::vector<const typename DirectedRootedTree<T>::TreeNode*> tree_algorithms::top_leaf_nodes(const DirectedRootedTree<T>& tree)
+{
+    const typename DirectedRootedTree<T>::node_children_t& children = tree.root()->children();
+    std::vector<const typename DirectedRootedTree<T>::TreeNode*> nodes;
+    nodes.reserve(children.size());
+    for (const typename DirectedRootedTree<T>::node_ptr_t& child : children)
+    {
+        nodes.push_back(child.get());
+    }
+    return nodes;
+}
+
+template <typename T>
+std::vector<const typename DirectedRootedTree<T>::TreeNode*> tree_algorithms::bottom_leaf_nodes(const DirectedRootedTree<T>& tree)
+{
+    std::vector<const typename DirectedRootedTree<T>::TreeNode*> nodes;
+    for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+    {
+        if (iter.current_node()->children().empty())
         {
-            tree.remove_node(child);
+            nodes.push_back(iter.current_node());
         }
     }
+    return nodes;
+}
 
-    return parallel_sequencing;
+template <typename T>
+tree_algorithms::NodeSequencing<T> tree_algorithms::lower_node_sequencing(const DirectedRootedTree<T>& tree)
+{
+    typedef typename NodeSequencing<T>::node_t node_t;
+
+    // Breadth-first order is exactly the concatenation of the levels,
+    // so the output buffer serves as the queue
+    std::vector<node_t> nodes = top_leaf_nodes(tree);
+    nodes.reserve(tree.size() - 1);
+    std::vector<size_t> level_offsets(1, 0);
+
+    size_t level_end = nodes.size();
+    for (size_t i = 0; i != nodes.size(); ++i)
+    {
+        if (i == level_end)
+        {
+            level_offsets.push_back(level_end);
+            level_end = nodes.size();
+        }
+        for (const typename DirectedRootedTree<T>::node_ptr_t& child : nodes[i]->children())
+        {
+            nodes.push_back(child.get());
+        }
+    }
+    if (!nodes.empty())
+    {
+        level_offsets.push_back(nodes.size());
+    }
+
+    return NodeSequencing<T>(std::move(nodes), std::move(level_offsets));
+}
+
+template <typename T>
+tree_algorithms::NodeSequencing<T> tree_algorithms::upper_node_sequencing(const DirectedRootedTree<T>& tree)
+{
+    typedef typename NodeSequencing<T>::node_t node_t;
+
+    std::vector<node_t> postorder_nodes;
+    std::vector<size_t> postorder_heights;
+    postorder_nodes.reserve(tree.size() - 1);
+    postorder_heights.reserve(tree.size() - 1);
+
+    // See upper_parallel_sequencing
+    std::vector<size_t> heights;
+    size_t levels_count = 0;
+    for (typename DirectedRootedTree<T>::PostorderIterator iter = tree.postorder().begin();
+         iter.current_node() != tree.root();
+         ++iter)
+    {
+        const size_t children_count = iter.current_node()->children().size();
+        size_t height = 0;
+        for (size_t i = heights.size() - children_count; i != heights.size(); ++i)
+        {
+            height = std::max(height, heights[i] + 1);
+        }
+        heights.resize(heights.size() - children_count);
+        heights.push_back(height);
+
+        postorder_nodes.push_back(iter.current_node());
+        postorder_heights.push_back(height);
+        levels_count = std::max(levels_count, height + 1);
+    }
+
+    // Stable counting sort by height keeps the preorder inside of the levels
+    std::vector<size_t> level_offsets(levels_count + 1, 0);
+    for (size_t height : postorder_heights)
+    {
+        ++level_offsets[height + 1];
+    }
+    for (size_t level = 0; level != levels_count; ++level)
+    {
+        level_offsets[level + 1] += level_offsets[level];
+    }
+    std::vector<size_t> positions(level_offsets.begin(), level_offsets.end() - 1);
+    std::vector<node_t> nodes(postorder_nodes.size());
+    for (size_t i = 0; i != postorder_nodes.size(); ++i)
+    {
+        nodes[positions[postorder_heights[i]]++] = postorder_nodes[i];
+    }
+
+    return NodeSequencing<T>(std::move(nodes), std::move(level_offsets));
+}
+
+namespace tree_algorithms
+{
+
+namespace detail
+{
+
+// Numbers the nodes in preorder, the root is not included
+template <typename T>
+void index_preorder(const DirectedRootedTree<T>& tree,
+                    std::vector<const typename DirectedRootedTree<T>::TreeNode*>& nodes,
+                    std::vector<size_t>& parents)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    nodes.reserve(tree.size() - 1);
+    parents.reserve(tree.size() - 1);
+
+    std::vector< std::pair<const TreeNode*, size_t> > pending;
+    const typename DirectedRootedTree<T>::node_children_t& root_children = tree.root()->children();
+    for (auto iter = root_children.rbegin(); iter != root_children.rend(); ++iter)
+    {
+        pending.emplace_back(iter->get(), no_parent_index);
+    }
+    while (!pending.empty())
+    {
+        const TreeNode* node = pending.back().first;
+        const size_t index = nodes.size();
+        nodes.push_back(node);
+        parents.push_back(pending.back().second);
+        pending.pop_back();
+
+        const typename DirectedRootedTree<T>::node_children_t& children = node->children();
+        for (auto iter = children.rbegin(); iter != children.rend(); ++iter)
+        {
+            pending.emplace_back(iter->get(), index);
+        }
+    }
+}
+
+}
+
+}
+
+template <typename T>
+tree_algorithms::NodeSequencing<T> tree_algorithms::upper_bounded_sequencing(const DirectedRootedTree<T>& tree, size_t width)
+{
+    typedef typename NodeSequencing<T>::node_t node_t;
+
+    if (width == 0)
+    {
+        throw std::invalid_argument("Stage width must be positive");
+    }
+
+    std::vector<node_t> nodes;
+    std::vector<size_t> parents;
+    detail::index_preorder(tree, nodes, parents);
+
+    std::vector<size_t> depths(nodes.size());
+    std::vector<size_t> pending_children(nodes.size(), 0);
+    size_t max_depth = 0;
+    for (size_t node = 0; node != nodes.size(); ++node)
+    {
+        depths[node] = parents[node] == no_parent_index ? 1 : depths[parents[node]] + 1;
+        max_depth = std::max(max_depth, depths[node]);
+        if (parents[node] != no_parent_index)
+        {
+            ++pending_children[parents[node]];
+        }
+    }
+
+    // Ready nodes are bucketed by depth, only the depths of non-empty buckets are kept ordered
+    std::vector< std::vector<size_t> > ready(max_depth + 1);
+    std::set<size_t> ready_depths;
+    for (size_t node = 0; node != nodes.size(); ++node)
+    {
+        if (pending_children[node] == 0)
+        {
+            ready[depths[node]].push_back(node);
+            ready_depths.insert(depths[node]);
+        }
+    }
+
+    std::vector<node_t> stages;
+    stages.reserve(nodes.size());
+    std::vector<size_t> level_offsets(1, 0);
+    std::vector<size_t> stage;
+    stage.reserve(std::min(width, nodes.size()));
+    while (!ready_depths.empty())
+    {
+        stage.clear();
+        while (stage.size() != width && !ready_depths.empty())
+        {
+            const size_t depth = *ready_depths.rbegin();
+            std::vector<size_t>& bucket = ready[depth];
+            while (stage.size() != width && !bucket.empty())
+            {
+                stage.push_back(bucket.back());
+                bucket.pop_back();
+            }
+            if (bucket.empty())
+            {
+                ready_depths.erase(depth);
+            }
+        }
+
+        // Parents become ready only for the next stage
+        for (size_t node : stage)
+        {
+            stages.push_back(nodes[node]);
+            const size_t parent = parents[node];
+            if (parent != no_parent_index && --pending_children[parent] == 0)
+            {
+                ready[depths[parent]].push_back(parent);
+                ready_depths.insert(depths[parent]);
+            }
+        }
+        level_offsets.push_back(stages.size());
+    }
+
+    return NodeSequencing<T>(std::move(stages), std::move(level_offsets));
+}
+
+template <typename T>
+tree_algorithms::NodeSequencing<T> tree_algorithms::lower_bounded_sequencing(const DirectedRootedTree<T>& tree, size_t width)
+{
+    typedef typename NodeSequencing<T>::node_t node_t;
+
+    const NodeSequencing<T> upper = upper_bounded_sequencing(tree, width);
+    std::vector<node_t> nodes;
+    nodes.reserve(upper.nodes().size());
+    std::vector<size_t> level_offsets(1, 0);
+    level_offsets.reserve(upper.levels_count() + 1);
+    for (size_t level = upper.levels_count(); level != 0; --level)
+    {
+        nodes.insert(nodes.end(), upper.level_begin(level - 1), upper.level_end(level - 1));
+        level_offsets.push_back(nodes.size());
+    }
+    return NodeSequencing<T>(std::move(nodes), std::move(level_offsets));
+}
+
+template <typename T, typename TWeight>
+tree_algorithms::WeightedSchedule<T> tree_algorithms::weighted_schedule(const DirectedRootedTree<T>& tree, TWeight weight)
+{
+    WeightedSchedule<T> schedule;
+    detail::index_preorder(tree, schedule.nodes, schedule.parents);
+
+    const size_t nodes_count = schedule.nodes.size();
+    schedule.weights.resize(nodes_count);
+    schedule.earliest_starts.resize(nodes_count);
+    schedule.latest_starts.resize(nodes_count);
+    schedule.duration = 0;
+
+    // A parent precedes its children in preorder
+    for (size_t node = 0; node != nodes_count; ++node)
+    {
+        schedule.weights[node] = weight(schedule.nodes[node]->value());
+        const size_t parent = schedule.parents[node];
+        schedule.earliest_starts[node] = parent == no_parent_index
+                ? 0.0
+                : schedule.earliest_starts[parent] + schedule.weights[parent];
+    }
+
+    // In reverse preorder all descendants of a node precede it.
+    // latest_starts temporarily holds the length of the longest chain starting at the node.
+    std::vector<size_t> critical_children(nodes_count, no_parent_index);
+    std::vector<double> tails(nodes_count, 0.0);    // Longest chain of the children
+    size_t critical_top = no_parent_index;
+    for (size_t node = nodes_count; node != 0; --node)
+    {
+        const size_t index = node - 1;
+        const double length = schedule.weights[index] + tails[index];
+        schedule.latest_starts[index] = length;
+
+        const size_t parent = schedule.parents[index];
+        if (parent == no_parent_index)
+        {
+            if (critical_top == no_parent_index || length >= schedule.duration)
+            {
+                schedule.duration = length;
+                critical_top = index;
+            }
+        }
+        else if (critical_children[parent] == no_parent_index || length >= tails[parent])
+        {
+            tails[parent] = length;
+            critical_children[parent] = index;
+        }
+    }
+    for (double& latest_start : schedule.latest_starts)
+    {
+        latest_start = schedule.duration - latest_start;
+    }
+
+    for (size_t node = critical_top; node != no_parent_index; node = critical_children[node])
+    {
+        schedule.critical_path.push_back(node);
+    }
+    return schedule;
+}
+
+template <typename T>
+std::vector< std::pair<const typename DirectedRootedTree<T>::TreeNode*, const typename DirectedRootedTree<T>::TreeNode*> >
+tree_algorithms::differing_nodes(const DirectedRootedTree<T>& left, const DirectedRootedTree<T>& right)
+{
+    typedef std::pair<const typename DirectedRootedTree<T>::TreeNode*, const typename DirectedRootedTree<T>::TreeNode*> node_pair_t;
+
+    if (!left.structural_hashing_enabled() || !right.structural_hashing_enabled())
+    {
+        throw std::logic_error("Structural hashing is not enabled");
+    }
+    if (!DirectedRootedTree<T>::same_hashers(left.structural_hasher(), right.structural_hasher()))
+    {
+        throw std::logic_error("Trees are hashed by different hashers");
+    }
+
+    std::vector<node_pair_t> differences;
+    std::vector<node_pair_t> pending(1, node_pair_t(left.root(), right.root()));
+    while (!pending.empty())
+    {
+        const node_pair_t nodes = pending.back();
+        pending.pop_back();
+        if (nodes.first->structural_hash() == nodes.second->structural_hash())
+        {
+            continue;
+        }
+
+        const typename DirectedRootedTree<T>::node_children_t& left_children = nodes.first->children();
+        const typename DirectedRootedTree<T>::node_children_t& right_children = nodes.second->children();
+        if (!(nodes.first->value() == nodes.second->value()) || left_children.size() != right_children.size())
+        {
+            differences.push_back(nodes);
+        }
+        for (size_t i = std::min(left_children.size(), right_children.size()); i != 0; --i)
+        {
+            pending.emplace_back(left_children[i - 1].get(), right_children[i - 1].get());
+        }
+    }
+    return differences;
+}
+
+template <typename T>
+std::vector< tree_algorithms::SlackWindow<T> > tree_algorithms::slack_windows(const DirectedRootedTree<T>& tree)
+{
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+
+    std::vector< SlackWindow<T> > windows;
+    windows.reserve(tree.size() - 1);
+
+    // Depth is known when a node is entered and height when it is left,
+    // latest_column temporarily holds the height
+    struct PathEntry
+    {
+        const TreeNode* node;
+        size_t next_child;
+        size_t window_index;
+        size_t height;
+    };
+    std::vector<PathEntry> path;
+    path.push_back(PathEntry{ tree.root(), 0, 0, 0 });
+    while (true)
+    {
+        PathEntry& entry = path.back();
+        if (entry.next_child != entry.node->children().size())
+        {
+            const TreeNode* child = entry.node->children()[entry.next_child++].get();
+            windows.push_back(SlackWindow<T>{ child, path.size() - 1, 0 });
+            path.push_back(PathEntry{ child, 0, windows.size() - 1, 0 });
+            continue;
+        }
+        if (path.size() == 1)
+        {
+            break;
+        }
+        windows[entry.window_index].latest_column = entry.height;
+        const size_t parent_height = entry.height + 1;
+        path.pop_back();
+        path.back().height = std::max(path.back().height, parent_height);
+    }
+
+    const size_t columns_count = path.back().height;
+    for (SlackWindow<T>& window : windows)
+    {
+        window.latest_column = columns_count - 1 - window.latest_column;
+    }
+    return windows;
 }
 
 #endif // TREEALGORITHMSIMPL_H
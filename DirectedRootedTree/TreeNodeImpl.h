@@ -3,6 +3,55 @@
 
 #include "DirectedRootedTree.h"
 
+template <typename T>
+DirectedRootedTree<T>::NodeDeleter::NodeDeleter(NodePool<TreeNode>* pool)
+    : m_pool(pool)
+{
+
+}
+
+template <typename T>
+void DirectedRootedTree<T>::NodeDeleter::operator()(TreeNode* node) const
+{
+    m_pool->destroy(node);
+}
+
+template <typename T>
+void DirectedRootedTree<T>::Listener::node_added(const TreeNode*)
+{
+
+}
+
+template <typename T>
+void DirectedRootedTree<T>::Listener::node_removing(const TreeNode*)
+{
+
+}
+
+template <typename T>
+void DirectedRootedTree<T>::Listener::node_removed(const TreeNode*, size_t, size_t)
+{
+
+}
+
+template <typename T>
+void DirectedRootedTree<T>::Listener::tree_replaced()
+{
+
+}
+
+template <typename T>
+void DirectedRootedTree<T>::Listener::value_changing(const TreeNode*)
+{
+
+}
+
+template <typename T>
+void DirectedRootedTree<T>::Listener::value_changed(const TreeNode*)
+{
+
+}
+
 template <typename T>
 const T& DirectedRootedTree<T>::TreeNode::value() const
 {
@@ -33,10 +82,42 @@ const typename DirectedRootedTree<T>::node_children_t& DirectedRootedTree<T>::Tr
     return m_children;
 }
 
+template <typename T>
+size_t DirectedRootedTree<T>::TreeNode::child_index() const
+{
+    return m_child_index;
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::TreeNode::structural_hash() const
+{
+    return m_aggregates ? m_aggregates->hash : 0;
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::TreeNode::depth() const
+{
+    return m_aggregates ? m_aggregates->depth : 0;
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::TreeNode::subtree_size() const
+{
+    return m_aggregates ? m_aggregates->subtree_size : 1;
+}
+
+template <typename T>
+size_t DirectedRootedTree<T>::TreeNode::height() const
+{
+    return m_aggregates ? m_aggregates->height : 0;
+}
+
 template <typename T>
 DirectedRootedTree<T>::TreeNode::TreeNode(const T& value, TreeNode* parent)
     : m_value(value),
-      m_parent(parent)
+      m_parent(parent),
+      m_child_index(0),
+      m_aggregates(nullptr)
 {
 
 }
@@ -44,14 +125,17 @@ DirectedRootedTree<T>::TreeNode::TreeNode(const T& value, TreeNode* parent)
 template <typename T>
 DirectedRootedTree<T>::TreeNode::TreeNode(T&& value, TreeNode* parent)
     : m_value(std::move(value)),
-      m_parent(parent)
+      m_parent(parent),
+      m_child_index(0),
+      m_aggregates(nullptr)
 {
 
 }
 
 template <typename T>
-typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::TreeNode::add_child(std::unique_ptr<TreeNode>&& child)
+typename DirectedRootedTree<T>::TreeNode* DirectedRootedTree<T>::TreeNode::add_child(node_ptr_t&& child)
 {
+    child->m_child_index = m_children.size();
     m_children.emplace_back(std::move(child));
     return m_children.back().get();
 }
@@ -0,0 +1,78 @@
+#ifndef VALUEINDEX_H
+#define VALUEINDEX_H
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "DirectedRootedTree.h"
+
+namespace tree_algorithms
+{
+
+// Which node find() returns for a key held by several nodes
+enum class duplicate_keys
+{
+    first,  /*!< The node indexed first: in preorder when built, then in the order of the edits */
+    last,   /*!< The node indexed last */
+    error   /*!< find() throws std::runtime_error */
+};
+
+// Hash index from the keys of the node values to the nodes, kept in sync with the tree by its notifications.
+// Added and removed nodes and values changed through DirectedRootedTree::set_value cost O(1) on average,
+// values changed through TreeNode::value() are not seen. Removing a node of a duplicated key also shifts
+// the nodes of the key indexed after it. The tree must outlive the index.
+template <typename T, typename TKey = T, typename THash = std::hash<TKey> >
+class ValueIndex : private DirectedRootedTree<T>::Listener
+{
+public:
+    typedef typename DirectedRootedTree<T>::TreeNode TreeNode;
+    typedef std::function<TKey(const T&)> key_extractor_t;
+
+public:
+    // The values themselves are the keys
+    explicit ValueIndex(DirectedRootedTree<T>& tree, duplicate_keys duplicates = duplicate_keys::first);
+    ValueIndex(DirectedRootedTree<T>& tree, key_extractor_t key_extractor,
+               duplicate_keys duplicates = duplicate_keys::first);
+    ~ValueIndex();
+
+    ValueIndex(const ValueIndex&) = delete;
+    ValueIndex& operator=(const ValueIndex&) = delete;
+
+    // nullptr if no node has the key
+    TreeNode* find(const TKey& key) const;
+    bool contains(const TKey& key) const;
+    size_t count(const TKey& key) const;
+    // In the order of indexing
+    std::vector<TreeNode*> find_all(const TKey& key) const;
+
+    size_t keys_count() const;
+
+private:
+    typedef std::vector<TreeNode*> key_nodes_t;
+
+    void node_added(const TreeNode* node) override;
+    void node_removing(const TreeNode* node) override;
+    void tree_replaced() override;
+    void value_changing(const TreeNode* node) override;
+    void value_changed(const TreeNode* node) override;
+
+    static TKey value_key(const T& value);
+
+    void rebuild();
+    void insert_node(const TreeNode* node);
+    void erase_node(const TreeNode* node);
+
+private:
+    DirectedRootedTree<T>& m_tree;
+    key_extractor_t m_key_extractor;
+    duplicate_keys m_duplicates;
+    std::unordered_map<TKey, key_nodes_t, THash> m_nodes;
+    std::unordered_map<const TreeNode*, size_t> m_positions; /*!< Position of each node in the nodes of its key */
+};
+
+}
+
+#include "ValueIndexImpl.h"
+
+#endif // VALUEINDEX_H
@@ -0,0 +1,164 @@
+#ifndef VALUEINDEXIMPL_H
+#define VALUEINDEXIMPL_H
+
+#include "ValueIndex.h"
+
+#include <stdexcept>
+
+template <typename T, typename TKey, typename THash>
+tree_algorithms::ValueIndex<T, TKey, THash>::ValueIndex(DirectedRootedTree<T>& tree, duplicate_keys duplicates)
+    : ValueIndex(tree, key_extractor_t(&ValueIndex::value_key), duplicates)
+{
+
+}
+
+template <typename T, typename TKey, typename THash>
+tree_algorithms::ValueIndex<T, TKey, THash>::ValueIndex(DirectedRootedTree<T>& tree, key_extractor_t key_extractor,
+                                                        duplicate_keys duplicates)
+    : m_tree(tree),
+      m_key_extractor(std::move(key_extractor)),
+      m_duplicates(duplicates)
+{
+    rebuild();
+    m_tree.add_listener(this);
+}
+
+template <typename T, typename TKey, typename THash>
+tree_algorithms::ValueIndex<T, TKey, THash>::~ValueIndex()
+{
+    m_tree.remove_listener(this);
+}
+
+template <typename T, typename TKey, typename THash>
+typename tree_algorithms::ValueIndex<T, TKey, THash>::TreeNode*
+tree_algorithms::ValueIndex<T, TKey, THash>::find(const TKey& key) const
+{
+    typename std::unordered_map<TKey, key_nodes_t, THash>::const_iterator iter = m_nodes.find(key);
+    if (iter == m_nodes.end())
+    {
+        return nullptr;
+    }
+    const key_nodes_t& nodes = iter->second;
+    if (m_duplicates == duplicate_keys::error && nodes.size() > 1)
+    {
+        throw std::runtime_error("Key is held by several nodes");
+    }
+    return m_duplicates == duplicate_keys::last ? nodes.back() : nodes.front();
+}
+
+template <typename T, typename TKey, typename THash>
+bool tree_algorithms::ValueIndex<T, TKey, THash>::contains(const TKey& key) const
+{
+    return m_nodes.count(key) != 0;
+}
+
+template <typename T, typename TKey, typename THash>
+size_t tree_algorithms::ValueIndex<T, TKey, THash>::count(const TKey& key) const
+{
+    typename std::unordered_map<TKey, key_nodes_t, THash>::const_iterator iter = m_nodes.find(key);
+    return iter == m_nodes.end() ? 0 : iter->second.size();
+}
+
+template <typename T, typename TKey, typename THash>
+std::vector<typename tree_algorithms::ValueIndex<T, TKey, THash>::TreeNode*>
+tree_algorithms::ValueIndex<T, TKey, THash>::find_all(const TKey& key) const
+{
+    typename std::unordered_map<TKey, key_nodes_t, THash>::const_iterator iter = m_nodes.find(key);
+    return iter == m_nodes.end() ? key_nodes_t() : iter->second;
+}
+
+template <typename T, typename TKey, typename THash>
+size_t tree_algorithms::ValueIndex<T, TKey, THash>::keys_count() const
+{
+    return m_nodes.size();
+}
+
+template <typename T, typename TKey, typename THash>
+void tree_algorithms::ValueIndex<T, TKey, THash>::node_added(const TreeNode* node)
+{
+    insert_node(node);
+}
+
+template <typename T, typename TKey, typename THash>
+void tree_algorithms::ValueIndex<T, TKey, THash>::node_removing(const TreeNode* node)
+{
+    erase_node(node);
+}
+
+template <typename T, typename TKey, typename THash>
+void tree_algorithms::ValueIndex<T, TKey, THash>::tree_replaced()
+{
+    rebuild();
+}
+
+template <typename T, typename TKey, typename THash>
+void tree_algorithms::ValueIndex<T, TKey, THash>::value_changing(const TreeNode* node)
+{
+    erase_node(node);
+}
+
+template <typename T, typename TKey, typename THash>
+void tree_algorithms::ValueIndex<T, TKey, THash>::value_changed(const TreeNode* node)
+{
+    insert_node(node);
+}
+
+template <typename T, typename TKey, typename THash>
+TKey tree_algorithms::ValueIndex<T, TKey, THash>::value_key(const T& value)
+{
+    return value;
+}
+
+template <typename T, typename TKey, typename THash>
+void tree_algorithms::ValueIndex<T, TKey, THash>::rebuild()
+{
+    m_nodes.clear();
+    m_positions.clear();
+    m_positions.reserve(m_tree.size());
+    const DirectedRootedTree<T>& tree = m_tree;
+    for (typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+    {
+        insert_node(iter.current_node());
+    }
+}
+
+template <typename T, typename TKey, typename THash>
+void tree_algorithms::ValueIndex<T, TKey, THash>::insert_node(const TreeNode* node)
+{
+    // Nodes are reached through the tree given to the constructor, which is not const
+    key_nodes_t& nodes = m_nodes[m_key_extractor(node->value())];
+    m_positions[node] = nodes.size();
+    nodes.push_back(const_cast<TreeNode*>(node));
+}
+
+template <typename T, typename TKey, typename THash>
+void tree_algorithms::ValueIndex<T, TKey, THash>::erase_node(const TreeNode* node)
+{
+    typename std::unordered_map<TKey, key_nodes_t, THash>::iterator iter = m_nodes.find(m_key_extractor(node->value()));
+    if (iter == m_nodes.end())
+    {
+        throw std::runtime_error("Inconsistent value index: node is not indexed");
+    }
+    key_nodes_t& nodes = iter->second;
+    typename std::unordered_map<const TreeNode*, size_t>::iterator position_iter = m_positions.find(node);
+    if (position_iter == m_positions.end() || position_iter->second >= nodes.size()
+        || nodes[position_iter->second] != node)
+    {
+        throw std::runtime_error("Inconsistent value index: node is not indexed");
+    }
+
+    // Duplicates keep the order of indexing, the nodes after the erased one move one position back
+    const size_t position = position_iter->second;
+    m_positions.erase(position_iter);
+    nodes.erase(nodes.begin() + position);
+    for (size_t moved_position = position; moved_position != nodes.size(); ++moved_position)
+    {
+        m_positions[nodes[moved_position]] = moved_position;
+    }
+    if (nodes.empty())
+    {
+        m_nodes.erase(iter);
+    }
+}
+
+#endif // VALUEINDEXIMPL_H
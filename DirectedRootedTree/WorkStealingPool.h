@@ -0,0 +1,230 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed size thread pool with a task queue per worker.
+// Workers take tasks from the back of their own queue and steal from the front of the others.
+// Tasks submitted from a worker thread go to the queue of that worker.
+class WorkStealingPool
+{
+public:
+    typedef std::function<void()> task_t;
+
+    explicit WorkStealingPool(size_t threads_count = std::thread::hardware_concurrency());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(task_t task);
+
+    // Blocks until all submitted tasks are finished, the calling thread runs tasks meanwhile.
+    // Rethrows the first exception thrown by a task.
+    void wait();
+
+    size_t threads_count() const;
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    void worker_loop(size_t worker);
+    bool pop_task(size_t worker, task_t& task);
+    void run_task(task_t& task);
+
+    static size_t& current_worker();
+
+private:
+    std::vector< std::unique_ptr<WorkerQueue> > m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_task_condition;
+    std::condition_variable m_done_condition;
+
+    std::atomic<size_t> m_queued_count;
+    std::atomic<size_t> m_pending_count;
+    std::atomic<size_t> m_next_queue;
+    bool m_stop;
+
+    std::exception_ptr m_exception;
+};
+
+inline WorkStealingPool::WorkStealingPool(size_t threads_count)
+    : m_queued_count(0),
+      m_pending_count(0),
+      m_next_queue(0),
+      m_stop(false)
+{
+    if (threads_count == 0)
+    {
+        threads_count = 1;
+    }
+    for (size_t i = 0; i != threads_count; ++i)
+    {
+        m_queues.emplace_back(new WorkerQueue());
+    }
+    for (size_t i = 0; i != threads_count; ++i)
+    {
+        m_threads.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+inline WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_task_condition.notify_all();
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+inline void WorkStealingPool::submit(task_t task)
+{
+    size_t worker = current_worker();
+    if (worker >= m_queues.size() || m_threads[worker].get_id() != std::this_thread::get_id())
+    {
+        worker = m_next_queue++ % m_queues.size();
+    }
+
+    ++m_pending_count;
+    {
+        std::lock_guard<std::mutex> lock(m_queues[worker]->mutex);
+        m_queues[worker]->tasks.push_back(std::move(task));
+        ++m_queued_count;
+    }
+    {
+        // Waiting threads check the counter under this mutex, so the notification is not lost
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_task_condition.notify_one();
+}
+
+inline void WorkStealingPool::wait()
+{
+    while (m_pending_count != 0)
+    {
+        task_t task;
+        if (pop_task(m_next_queue % m_queues.size(), task))
+        {
+            run_task(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done_condition.wait(lock, [this]() -> bool
+        {
+            return m_pending_count == 0 || m_queued_count != 0;
+        });
+    }
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(exception, m_exception);
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+inline size_t WorkStealingPool::threads_count() const
+{
+    return m_threads.size();
+}
+
+inline void WorkStealingPool::worker_loop(size_t worker)
+{
+    current_worker() = worker;
+    while (true)
+    {
+        task_t task;
+        if (pop_task(worker, task))
+        {
+            run_task(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task_condition.wait(lock, [this]() -> bool
+        {
+            return m_stop || m_queued_count != 0;
+        });
+        if (m_stop && m_queued_count == 0)
+        {
+            return;
+        }
+    }
+}
+
+inline bool WorkStealingPool::pop_task(size_t worker, task_t& task)
+{
+    {
+        WorkerQueue& own_queue = *m_queues[worker];
+        std::lock_guard<std::mutex> lock(own_queue.mutex);
+        if (!own_queue.tasks.empty())
+        {
+            task = std::move(own_queue.tasks.back());
+            own_queue.tasks.pop_back();
+            --m_queued_count;
+            return true;
+        }
+    }
+    for (size_t i = 1; i != m_queues.size(); ++i)
+    {
+        WorkerQueue& victim_queue = *m_queues[(worker + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim_queue.mutex);
+        if (!victim_queue.tasks.empty())
+        {
+            task = std::move(victim_queue.tasks.front());
+            victim_queue.tasks.pop_front();
+            --m_queued_count;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void WorkStealingPool::run_task(task_t& task)
+{
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_exception)
+        {
+            m_exception = std::current_exception();
+        }
+    }
+    if (--m_pending_count == 0)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done_condition.notify_all();
+    }
+}
+
+inline size_t& WorkStealingPool::current_worker()
+{
+    static thread_local size_t worker = static_cast<size_t>(-1);
+    return worker;
+}
+
+#endif // WORKSTEALINGPOOL_H
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <unordered_map>
 #include <utility>
 
 #include <QMimeData>
@@ -12,19 +13,18 @@
 namespace
 {
 
-int findCol(const tree_algorithms::parallel_sequencing_t<std::string>& sequencing,
-            const std::string& itemName)
+// Maps every item to the first column of the sequencing that contains it
+std::unordered_map<std::string, int> indexCols(const tree_algorithms::parallel_sequencing_t<std::string>& sequencing)
 {
-    auto iter = std::find_if(sequencing.begin(), sequencing.end(),
-                             [&itemName](const std::vector<std::string>& col) -> bool
+    std::unordered_map<std::string, int> cols;
+    for (size_t col = 0; col != sequencing.size(); ++col)
     {
-        return std::find(col.begin(), col.end(), itemName) != col.end();
-    });
-    if (iter != sequencing.end())
-    {
-        return static_cast<int>(iter - sequencing.begin());
+        for (const std::string& itemName : sequencing[col])
+        {
+            cols.emplace(itemName, static_cast<int>(col));
+        }
     }
-    return -1;
+    return cols;
 }
 
 }
@@ -33,7 +33,8 @@ SequencingModel::SequencingModel(const tree_algorithms::parallel_sequencing_t<st
                                  const tree_algorithms::parallel_sequencing_t<std::string>& upperSequencing,
                                  QObject* parent)
     : QAbstractTableModel(parent),
-      m_sequencing(lowerSequencing.size())
+      m_sequencing(lowerSequencing.size()),
+      m_duplicateNames(false)
 {
     if (lowerSequencing.size() != upperSequencing.size())
     {
@@ -41,13 +42,14 @@ SequencingModel::SequencingModel(const tree_algorithms::parallel_sequencing_t<st
                lowerSequencing.size(), upperSequencing.size());
         return;
     }
+    const std::unordered_map<std::string, int> upperCols = indexCols(upperSequencing);
     for (size_t col = 0; col != lowerSequencing.size(); ++col)
     {
         m_sequencing[col].reserve(lowerSequencing[col].size());
         for (size_t row = 0; row != lowerSequencing[col].size(); ++row)
         {
-            int upperCol = findCol(upperSequencing, lowerSequencing[col][row]);
-            if (upperCol == -1)
+            auto upperColIter = upperCols.find(lowerSequencing[col][row]);
+            if (upperColIter == upperCols.end())
             {
                 qFatal("Upper sequencing must contain exactly "
                        "the same elements as lower sequencing");
@@ -55,9 +57,40 @@ SequencingModel::SequencingModel(const tree_algorithms::parallel_sequencing_t<st
             }
             m_sequencing[col].emplace_back(QString::fromStdString(lowerSequencing[col][row]),
                                            static_cast<int>(col),
-                                           upperCol);
+                                           upperColIter->second);
         }
     }
+    indexItems();
+}
+
+SequencingModel::SequencingModel(const DirectedRootedTree<std::string>& tree, QObject* parent)
+    : QAbstractTableModel(parent),
+      m_duplicateNames(false)
+{
+    const std::vector< tree_algorithms::SlackWindow<std::string> > windows = tree_algorithms::slack_windows(tree);
+
+    std::vector<size_t> colsSizes;
+    for (const tree_algorithms::SlackWindow<std::string>& window : windows)
+    {
+        if (window.earliest_column >= colsSizes.size())
+        {
+            colsSizes.resize(window.earliest_column + 1, 0);
+        }
+        ++colsSizes[window.earliest_column];
+    }
+
+    m_sequencing.resize(colsSizes.size());
+    for (size_t col = 0; col != colsSizes.size(); ++col)
+    {
+        m_sequencing[col].reserve(colsSizes[col]);
+    }
+    for (const tree_algorithms::SlackWindow<std::string>& window : windows)
+    {
+        m_sequencing[window.earliest_column].emplace_back(QString::fromStdString(window.node->value()),
+                                                          static_cast<int>(window.earliest_column),
+                                                          static_cast<int>(window.latest_column));
+    }
+    indexItems();
 }
 
 Qt::ItemFlags SequencingModel::flags(const QModelIndex& index) const
@@ -169,6 +202,16 @@ bool SequencingModel::setData(const QModelIndex& index, const QVariant& value, i
                 using std::swap;
                 swap(m_sequencing[index.column()][index.row()],
                      m_sequencing[itemPos.first][itemPos.second]);
+                if (m_duplicateNames)
+                {
+                    indexItems();
+                }
+                else
+                {
+                    m_itemsPos[m_sequencing[index.column()][index.row()].name] =
+                            std::make_pair(index.column(), index.row());
+                    m_itemsPos[m_sequencing[itemPos.first][itemPos.second].name] = itemPos;
+                }
 
                 QModelIndex itemIndex = createIndex(itemPos.second, itemPos.first);
                 emit dataChanged(itemIndex, itemIndex);
@@ -179,6 +222,15 @@ bool SequencingModel::setData(const QModelIndex& index, const QVariant& value, i
                 const Item& item = m_sequencing[itemPos.first][itemPos.second];
                 m_sequencing[index.column()].emplace_back(item.name, item.leftBorder, item.rightBorder);
                 m_sequencing[itemPos.first].erase(m_sequencing[itemPos.first].begin() + itemPos.second);
+                if (m_duplicateNames)
+                {
+                    indexItems();
+                }
+                else
+                {
+                    indexItems(itemPos.first, itemPos.second);
+                    indexItems(index.column(), static_cast<int>(m_sequencing[index.column()].size()) - 1);
+                }
 
                 QModelIndex itemIndex = createIndex(
                                             static_cast<int>(m_sequencing[index.column()].size()) - 1,
@@ -328,16 +380,29 @@ SequencingModel::Item::Item(const QString& name, int leftBorder, int rightBorder
 
 std::pair<int, int> SequencingModel::findItemPos(const QString& itemName) const
 {
-    for (size_t col = 0; col != m_sequencing.size(); ++col)
+    return m_itemsPos.value(itemName, std::make_pair(-1, -1));
+}
+
+void SequencingModel::indexItems()
+{
+    m_itemsPos.clear();
+    int itemsCount = 0;
+    // Items are indexed backwards, so the first of equally named items is found, as by a scan
+    for (int col = static_cast<int>(m_sequencing.size()) - 1; col >= 0; --col)
     {
-        auto iter = std::find_if(m_sequencing[col].begin(),
-                                 m_sequencing[col].end(),
-                                 [&itemName](const Item& item) -> bool { return item.name == itemName; });
-        if (iter != m_sequencing[col].end())
+        for (int row = static_cast<int>(m_sequencing[col].size()) - 1; row >= 0; --row)
         {
-            return std::make_pair(static_cast<int>(col),
-                                  static_cast<int>(iter - m_sequencing[col].begin()));
+            m_itemsPos.insert(m_sequencing[col][row].name, std::make_pair(col, row));
+            ++itemsCount;
         }
     }
-    return std::make_pair(-1, -1);
+    m_duplicateNames = m_itemsPos.size() != itemsCount;
+}
+
+void SequencingModel::indexItems(int col, int firstRow)
+{
+    for (int row = firstRow; row < static_cast<int>(m_sequencing[col].size()); ++row)
+    {
+        m_itemsPos.insert(m_sequencing[col][row].name, std::make_pair(col, row));
+    }
 }
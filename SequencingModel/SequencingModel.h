@@ -2,6 +2,7 @@
 #define SEQUENCINGMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
 
 #include "TreeAlgorithms.h"
 
@@ -13,6 +14,8 @@ public:
     SequencingModel(const tree_algorithms::parallel_sequencing_t<std::string>& lowerSequencing,
                     const tree_algorithms::parallel_sequencing_t<std::string>& upperSequencing,
                     QObject* parent = nullptr);
+    explicit SequencingModel(const DirectedRootedTree<std::string>& tree,
+                             QObject* parent = nullptr);
 
     Qt::ItemFlags flags(const QModelIndex& index) const override;
 
@@ -47,9 +50,13 @@ private:
 
 private:
     std::pair<int, int> findItemPos(const QString& itemName) const;
+    void indexItems();
+    void indexItems(int col, int firstRow);
 
 private:
     tree_algorithms::parallel_sequencing_t<Item> m_sequencing;
+    QHash< QString, std::pair<int, int> > m_itemsPos;   // Column and row of every item
+    bool m_duplicateNames;  // Moved items are then indexed anew, so the first of equally named items is found
 };
 
 #endif // SEQUENCINGMODEL_H
@@ -3,6 +3,21 @@
 
 #include "DirectedRootedTree.h"
 #include "TreeAlgorithms.h"
+#include "FlatDirectedRootedTree.h"
+#include "ParallelTreeAlgorithms.h"
+#include "IncrementalSequencer.h"
+#include "GraphAlgorithms.h"
+#include "SequencingCache.h"
+#include "PersistentTreeAlgorithms.h"
+#include "PublishedTree.h"
+#include "AncestorIndex.h"
+#include "ValueIndex.h"
+
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <tuple>
 
 #define ASSERT_THROWS(EXPR, EXCEPTION, FAIL_MSG) \
     try \
@@ -41,6 +56,11 @@ private Q_SLOTS:
     void iterator_postfix_inc_data();
     void iterator_postfix_inc();
 
+    void const_iterator();
+    void postorder_traversal();
+    void breadth_first_traversal();
+    void levels_traversal();
+
     void equal_data();
     void equal();
 
@@ -48,15 +68,52 @@ private Q_SLOTS:
     void not_equal();
 
     void remove_node();
+    void remove_node_with_one_child();
+    void remove_nodes();
+
+    void reuse_removed_nodes();
+    void destroy_deep_tree();
+    void move_tree();
+    void copy_tree();
+    void structural_hashing();
+    void differing_nodes();
+    void node_metrics();
+    void persistent_tree();
+    void published_tree();
+    void concurrent_build();
+    void cache_line_aligned();
 
     void algo_top_leaves();
     void algo_bottom_leaves();
 
     void algo_lower_parallel_sequencing();
     void algo_upper_parallel_sequencing();
+    void algo_parallel_sequencing_unbalanced();
+
+    void algo_node_sequencing();
+    void algo_slack_windows();
+    void algo_lazy_sequencing();
+    void algo_incremental_sequencing();
+    void algo_bounded_sequencing();
+    void algo_weighted_schedule();
+    void algo_sequencing_cache();
+
+    void algo_multithreaded_sequencing_data();
+    void algo_multithreaded_sequencing();
+    void algo_parallel_for_each_data();
+    void algo_parallel_for_each();
+    void algo_ancestor_index();
+    void algo_value_index();
+
+    void flat_tree_conversion();
+    void flat_tree_remove_node();
+    void graph_tree_conversion();
+    void graph_sequencing();
+    void graph_cycle_detection();
 
 private:
     DirectedRootedTree<int> build_multilayer_tree(std::vector<int>& nodes_values_depth_first) const;
+    DirectedRootedTree<int> build_random_tree(size_t nodes_count, size_t max_parent_distance, unsigned seed) const;
 
     template <typename T>
     bool is_tree_consistent(const DirectedRootedTree<T>& tree) const;
@@ -299,6 +356,88 @@ void DirectedRootedTreeTest::iterator_postfix_inc()
     }
 }
 
+void DirectedRootedTreeTest::const_iterator()
+{
+    std::vector<int> nodes_values;
+    const DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    QVERIFY(std::equal(tree.cbegin(), tree.cend(), nodes_values.begin()));
+    QCOMPARE(static_cast<size_t>(std::distance(tree.begin(), tree.end())), nodes_values.size());
+
+    DirectedRootedTree<int>::ConstIterator iter = tree.cbegin();
+    QCOMPARE(iter.current_node(), tree.root());
+    QCOMPARE(*iter++, nodes_values[0]);
+    QCOMPARE(*iter, nodes_values[1]);
+    QCOMPARE(iter.current_node()->parent(), tree.root());
+}
+
+void DirectedRootedTreeTest::postorder_traversal()
+{
+    std::vector<int> nodes_values;
+    const DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    std::vector<size_t> expected_order = { 3, 2, 1, 6, 5, 8, 9, 7, 4, 12, 11, 14, 15, 13, 17, 18, 19, 16, 10, 0 };
+    std::vector<int> expected_values;
+    for (size_t index : expected_order)
+    {
+        expected_values.push_back(nodes_values[index]);
+    }
+
+    std::vector<int> actual_values;
+    for (int value : tree.postorder())
+    {
+        actual_values.push_back(value);
+    }
+    QCOMPARE(actual_values, expected_values);
+    QCOMPARE(tree.postorder().begin().current_node(), tree.root()->children()[0]->children()[0]->children()[0].get());
+
+    DirectedRootedTree<int> single(5);
+    QCOMPARE(*single.postorder().begin(), 5);
+    QVERIFY(++single.postorder().begin() == single.postorder().end());
+}
+
+void DirectedRootedTreeTest::breadth_first_traversal()
+{
+    std::vector<int> nodes_values;
+    const DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    std::vector<size_t> expected_order = { 0, 1, 4, 10, 2, 5, 7, 11, 13, 16, 3, 6, 8, 9, 12, 14, 15, 17, 18, 19 };
+    std::vector<int> expected_values;
+    for (size_t index : expected_order)
+    {
+        expected_values.push_back(nodes_values[index]);
+    }
+
+    std::vector<int> actual_values;
+    for (int value : tree.breadth_first())
+    {
+        actual_values.push_back(value);
+    }
+    QCOMPARE(actual_values, expected_values);
+}
+
+void DirectedRootedTreeTest::levels_traversal()
+{
+    std::vector<int> nodes_values;
+    const DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    std::vector<size_t> expected_sizes = { 1, 3, 6, 10 };
+    std::vector<size_t> actual_sizes;
+    size_t depth = 0;
+    for (DirectedRootedTree<int>::LevelIterator iter = tree.levels().begin(); iter != tree.levels().end(); ++iter)
+    {
+        QCOMPARE(iter.depth(), depth++);
+        actual_sizes.push_back(iter->size());
+    }
+    QCOMPARE(actual_sizes, expected_sizes);
+
+    DirectedRootedTree<int>::LevelIterator top_level_iter = ++tree.levels().begin();
+    const DirectedRootedTree<int>::level_nodes_t& top_level = *top_level_iter;
+    QCOMPARE(top_level[0], tree.root()->children()[0].get());
+    QCOMPARE(top_level[1], tree.root()->children()[1].get());
+    QCOMPARE(top_level[2], tree.root()->children()[2].get());
+}
+
 void DirectedRootedTreeTest::equal_data()
 {
     QTest::addColumn< std::vector<int> >("left_tree_data");
@@ -410,6 +549,227 @@ void DirectedRootedTreeTest::remove_node()
     QVERIFY(std::equal(tree.begin(), tree.end(), nodes_values.begin()));
 }
 
+void DirectedRootedTreeTest::remove_node_with_one_child()
+{
+    std::vector<int> nodes_values;
+    DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    tree.remove_node(tree.root()->children()[0].get());
+    QVERIFY(is_tree_consistent(tree));
+    QCOMPARE(tree.root()->children().size(), 3ul);
+
+    nodes_values.erase(nodes_values.begin() + 1);
+    QCOMPARE(tree.size(), nodes_values.size());
+    QVERIFY(std::equal(tree.begin(), tree.end(), nodes_values.begin()));
+
+    tree.remove_node(tree.root()->children()[2].get());
+    QVERIFY(is_tree_consistent(tree));
+    QCOMPARE(tree.root()->children().size(), 5ul);
+
+    nodes_values.erase(nodes_values.begin() + 9);
+    QCOMPARE(tree.size(), nodes_values.size());
+    QVERIFY(std::equal(tree.begin(), tree.end(), nodes_values.begin()));
+}
+
+void DirectedRootedTreeTest::remove_nodes()
+{
+    std::vector<int> nodes_values;
+    DirectedRootedTree<int> expected_tree = build_multilayer_tree(nodes_values);
+    DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    // Second top node, its second child and the third top node with its first grandchild
+    std::vector<DirectedRootedTree<int>::TreeNode*> removed_nodes = {
+        tree.root()->children()[1]->children()[1].get(),
+        tree.root()->children()[1].get(),
+        tree.root()->children()[2].get(),
+        tree.root()->children()[2]->children()[1]->children()[0].get()
+    };
+    std::vector<DirectedRootedTree<int>::TreeNode*> expected_removed_nodes = {
+        expected_tree.root()->children()[1]->children()[1].get(),
+        expected_tree.root()->children()[1].get(),
+        expected_tree.root()->children()[2].get(),
+        expected_tree.root()->children()[2]->children()[1]->children()[0].get()
+    };
+    for (DirectedRootedTree<int>::TreeNode* node : expected_removed_nodes)
+    {
+        expected_tree.remove_node(node);
+    }
+
+    // Listeners receive the runs of the spliced children
+    typedef std::tuple<const DirectedRootedTree<int>::TreeNode*, size_t, size_t> removal_t;
+    struct RemovalRecorder : DirectedRootedTree<int>::Listener
+    {
+        void node_removed(const DirectedRootedTree<int>::TreeNode* parent,
+                          size_t first_child, size_t children_count) override
+        {
+            removals.emplace_back(parent, first_child, children_count);
+        }
+
+        std::vector<removal_t> removals;
+    } recorder;
+    QVERIFY(!tree.has_listeners());
+    tree.add_listener(&recorder);
+    QVERIFY(tree.has_listeners());
+    std::vector<removal_t> expected_removals = {
+        removal_t(tree.root(), 1, 6),
+        removal_t(tree.root()->children()[2]->children()[1].get(), 0, 0)
+    };
+
+    tree.remove_nodes(removed_nodes);
+    std::sort(recorder.removals.begin(), recorder.removals.end());
+    std::sort(expected_removals.begin(), expected_removals.end());
+    QVERIFY(recorder.removals == expected_removals);
+    QVERIFY(is_tree_consistent(tree));
+    QCOMPARE(tree.size(), expected_tree.size());
+    QVERIFY(tree == expected_tree);
+    QCOMPARE(tree.root()->children().size(), expected_tree.root()->children().size());
+    for (size_t i = 0; i != tree.root()->children().size(); ++i)
+    {
+        QCOMPARE(tree.root()->children()[i]->children().size(),
+                 expected_tree.root()->children()[i]->children().size());
+    }
+
+    std::vector<DirectedRootedTree<int>::TreeNode*> root_nodes = { tree.root() };
+    ASSERT_THROWS(tree.remove_nodes(root_nodes), std::logic_error,
+                  "logic_error exception must be thrown on removing the root node");
+
+    // A node of another tree is rejected before any of the trees is changed
+    DirectedRootedTree<int> other_tree = build_multilayer_tree(nodes_values);
+    const DirectedRootedTree<int> other_tree_copy(other_tree);
+    const DirectedRootedTree<int> tree_copy(tree);
+    std::vector<DirectedRootedTree<int>::TreeNode*> foreign_nodes = {
+        tree.root()->children()[0].get(),
+        other_tree.root()->children()[1]->children()[0].get()
+    };
+    recorder.removals.clear();
+    ASSERT_THROWS(tree.remove_nodes(foreign_nodes), std::invalid_argument,
+                  "invalid_argument exception must be thrown on removing a node of another tree");
+    QVERIFY(recorder.removals.empty());
+    QCOMPARE(tree.size(), tree_copy.size());
+    QVERIFY(tree == tree_copy);
+    QVERIFY(is_tree_consistent(tree));
+    QCOMPARE(other_tree.size(), other_tree_copy.size());
+    QVERIFY(other_tree == other_tree_copy);
+    QVERIFY(is_tree_consistent(other_tree));
+
+    DirectedRootedTree<int>::TreeNode* spliced_node = tree.root()->children()[0].get();
+    tree.remove_node(spliced_node);
+    QVERIFY(recorder.removals == std::vector<removal_t>(1, removal_t(tree.root(), 0, 1)));
+    tree.remove_listener(&recorder);
+    QVERIFY(!tree.has_listeners());
+}
+
+void DirectedRootedTreeTest::reuse_removed_nodes()
+{
+    std::vector<int> nodes_values;
+    DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    DirectedRootedTree<int>::TreeNode* removed = tree.root()->children()[0]->children()[0].get();
+    tree.remove_node(removed);
+    DirectedRootedTree<int>::TreeNode* added = tree.add_child(tree.root(), 42);
+    QCOMPARE(added, removed);
+    QCOMPARE(added->value(), 42);
+    QCOMPARE(added->parent(), tree.root());
+    QVERIFY(added->children().empty());
+    QCOMPARE(tree.size(), nodes_values.size());
+    QVERIFY(is_tree_consistent(tree));
+}
+
+void DirectedRootedTreeTest::destroy_deep_tree()
+{
+    DirectedRootedTree<int> tree(0);
+    tree.reserve(100000);
+    DirectedRootedTree<int>::TreeNode* node = tree.root();
+    for (int i = 1; i != 100000; ++i)
+    {
+        node = tree.add_child(node, i);
+    }
+    QCOMPARE(tree.size(), 100000ul);
+}
+
+void DirectedRootedTreeTest::move_tree()
+{
+    std::vector<int> nodes_values;
+    DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    DirectedRootedTree<int> moved(std::move(tree));
+    QCOMPARE(moved.size(), nodes_values.size());
+    QVERIFY(std::equal(moved.begin(), moved.end(), nodes_values.begin()));
+
+    // A moved-from tree is empty, it can only be assigned to
+    QCOMPARE(tree.size(), 0ul);
+    QVERIFY(tree.root() == nullptr);
+    QVERIFY(tree.begin() == tree.end());
+    ASSERT_THROWS(tree.add_child(moved.root(), 1), std::logic_error,
+                  "logic_error exception must be thrown on adding to a moved-from tree")
+    ASSERT_THROWS(tree.reserve(10), std::logic_error,
+                  "logic_error exception must be thrown on reserving in a moved-from tree")
+    QCOMPARE(moved.size(), nodes_values.size());
+    tree = DirectedRootedTree<int>(7);
+    tree.add_child(tree.root(), 8);
+    QCOMPARE(tree.size(), 2ul);
+
+    DirectedRootedTree<int> assigned(-1);
+    assigned.add_child(assigned.root(), -2);
+    assigned = std::move(moved);
+    QCOMPARE(assigned.size(), nodes_values.size());
+    QVERIFY(std::equal(assigned.begin(), assigned.end(), nodes_values.begin()));
+    QVERIFY(is_tree_consistent(assigned));
+
+    // Growing vector moves the trees instead of copying them
+    static_assert(std::is_nothrow_move_constructible< DirectedRootedTree<int> >::value,
+                  "DirectedRootedTree must be nothrow move constructible");
+    std::vector< DirectedRootedTree<int> > trees;
+    trees.push_back(std::move(assigned));
+    const DirectedRootedTree<int>::TreeNode* root = trees.front().root();
+    for (int i = 0; i != 100; ++i)
+    {
+        trees.emplace_back(i);
+    }
+    QCOMPARE(trees.front().root(), root);
+    QCOMPARE(trees.front().size(), nodes_values.size());
+}
+
+void DirectedRootedTreeTest::copy_tree()
+{
+    const DirectedRootedTree<int> tree = build_random_tree(5000, 40, 43);
+
+    DirectedRootedTree<int> copy(tree);
+    QCOMPARE(copy.size(), tree.size());
+    QVERIFY(copy == tree);
+    QVERIFY(is_tree_consistent(copy));
+
+    // All nodes are placed in preorder one after another
+    std::vector<const char*> addresses;
+    for (DirectedRootedTree<int>::ConstIterator iter = copy.cbegin(); iter != copy.cend(); ++iter)
+    {
+        addresses.push_back(reinterpret_cast<const char*>(iter.current_node()));
+    }
+    const std::ptrdiff_t stride = addresses[1] - addresses[0];
+    QVERIFY(stride >= static_cast<std::ptrdiff_t>(sizeof(DirectedRootedTree<int>::TreeNode)));
+    for (size_t i = 1; i != addresses.size(); ++i)
+    {
+        QCOMPARE(addresses[i] - addresses[i - 1], stride);
+    }
+
+    copy.remove_node(copy.root()->children().front().get());
+    QCOMPARE(copy.size(), tree.size() - 1);
+    QVERIFY(copy != tree);
+
+    DirectedRootedTree<int> hashed_tree = tree.clone();
+    hashed_tree.enable_structural_hashing();
+    DirectedRootedTree<int> assigned(-1);
+    assigned = hashed_tree;
+    QVERIFY(assigned.structural_hashing_enabled());
+    QCOMPARE(assigned.root()->structural_hash(), hashed_tree.root()->structural_hash());
+    QVERIFY(assigned == tree);
+
+    DirectedRootedTree<int> moved(std::move(hashed_tree));
+    DirectedRootedTree<int> empty_copy(hashed_tree);
+    QCOMPARE(empty_copy.size(), 0ul);
+    QVERIFY(empty_copy.root() == nullptr);
+}
+
 void DirectedRootedTreeTest::algo_top_leaves()
 {
     {
@@ -485,12 +845,17 @@ void DirectedRootedTreeTest::algo_lower_parallel_sequencing()
           nodes_values[14], nodes_values[15], nodes_values[17], nodes_values[18], nodes_values[19] }
     };
     QCOMPARE(parallel_sequencing_actual, parallel_sequencing_expected);
+
+    // The tree is left intact
+    QCOMPARE(tree.size(), nodes_values.size());
+    QVERIFY(std::equal(tree.begin(), tree.end(), nodes_values.begin()));
+
+    DirectedRootedTree<int> single(0);
+    QVERIFY(tree_algorithms::lower_parallel_sequencing(single).empty());
 }
 
 void DirectedRootedTreeTest::algo_upper_parallel_sequencing()
 {
-    // TODO: create the test tree for which lower and upper parallel sequencings will be different
-
     std::vector<int> nodes_values;
     DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
 
@@ -502,6 +867,1358 @@ void DirectedRootedTreeTest::algo_upper_parallel_sequencing()
         { nodes_values[1], nodes_values[4], nodes_values[10] }
     };
     QCOMPARE(parallel_sequencing_actual, parallel_sequencing_expected);
+
+    // The tree is left intact
+    QCOMPARE(tree.size(), nodes_values.size());
+    QVERIFY(std::equal(tree.begin(), tree.end(), nodes_values.begin()));
+
+    DirectedRootedTree<int> single(0);
+    QVERIFY(tree_algorithms::upper_parallel_sequencing(single).empty());
+}
+
+void DirectedRootedTreeTest::algo_parallel_sequencing_unbalanced()
+{
+    DirectedRootedTree<int> tree(0);
+    DirectedRootedTree<int>::TreeNode* a = tree.add_child(tree.root(), 1);
+    tree.add_child(tree.root(), 2);
+    DirectedRootedTree<int>::TreeNode* b = tree.add_child(a, 3);
+    tree.add_child(b, 4);
+    tree.add_child(a, 5);
+
+    tree_algorithms::parallel_sequencing_t<int> lower_expected = { { 1, 2 }, { 3, 5 }, { 4 } };
+    tree_algorithms::parallel_sequencing_t<int> upper_expected = { { 4, 5, 2 }, { 3 }, { 1 } };
+    QCOMPARE(tree_algorithms::lower_parallel_sequencing(tree), lower_expected);
+    QCOMPARE(tree_algorithms::upper_parallel_sequencing(tree), upper_expected);
+}
+
+void DirectedRootedTreeTest::structural_hashing()
+{
+    // Same values in preorder, different shapes
+    DirectedRootedTree<int> chain(0);
+    chain.add_child(chain.add_child(chain.root(), 1), 2);
+    DirectedRootedTree<int> fork(0);
+    fork.add_child(fork.root(), 1);
+    fork.add_child(fork.root(), 2);
+    QVERIFY(chain != fork);
+    chain.enable_structural_hashing();
+    fork.enable_structural_hashing();
+    QVERIFY(chain.root()->structural_hash() != fork.root()->structural_hash());
+    QVERIFY(chain != fork);
+
+    // Hashes kept up to date by the edits are the same as the ones computed from scratch
+    auto hashes = [](const DirectedRootedTree<int>& tree)
+    {
+        DirectedRootedTree<int> rehashed_tree = FlatDirectedRootedTree<int>(tree).to_tree();
+        rehashed_tree.enable_structural_hashing();
+        std::vector<size_t> expected_hashes, actual_hashes;
+        for (DirectedRootedTree<int>::ConstIterator iter = rehashed_tree.cbegin(); iter != rehashed_tree.cend(); ++iter)
+        {
+            expected_hashes.push_back(iter.current_node()->structural_hash());
+        }
+        for (DirectedRootedTree<int>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+        {
+            actual_hashes.push_back(iter.current_node()->structural_hash());
+        }
+        return std::make_pair(expected_hashes, actual_hashes);
+    };
+
+    DirectedRootedTree<int> tree = build_random_tree(1000, 15, 23);
+    tree.enable_structural_hashing();
+    QVERIFY(tree.structural_hashing_enabled());
+    std::mt19937 generator(29);
+    for (int edit = 0; edit != 200; ++edit)
+    {
+        std::vector<DirectedRootedTree<int>::TreeNode*> nodes;
+        for (DirectedRootedTree<int>::Iterator iter = tree.begin(); iter != tree.end(); ++iter)
+        {
+            nodes.push_back(iter.current_node());
+        }
+        std::uniform_int_distribution<size_t> distribution(1, nodes.size() - 1);
+        switch (edit % 4)
+        {
+        case 0:
+            tree.add_child(nodes[distribution(generator) - 1], edit);
+            break;
+        case 1:
+            tree.remove_node(nodes[distribution(generator)]);
+            break;
+        case 2:
+            tree.set_value(nodes[distribution(generator) - 1], -edit);
+            break;
+        default:
+            tree.remove_nodes(std::vector<DirectedRootedTree<int>::TreeNode*>({ nodes[distribution(generator)],
+                                                                                nodes[distribution(generator)] }));
+            break;
+        }
+        std::pair< std::vector<size_t>, std::vector<size_t> > expected_actual = hashes(tree);
+        QCOMPARE(expected_actual.second, expected_actual.first);
+    }
+
+    DirectedRootedTree<int> same_tree = FlatDirectedRootedTree<int>(tree).to_tree();
+    same_tree.enable_structural_hashing();
+    QVERIFY(same_tree == tree);
+    same_tree.set_value(same_tree.root()->children().front().get(), 100000);
+    QVERIFY(same_tree != tree);
+
+    // Different hashers of the same type do not make equal trees different
+    struct Hashers
+    {
+        static size_t identity(const int& value)
+        {
+            return static_cast<size_t>(value);
+        }
+
+        static size_t shifted(const int& value)
+        {
+            return static_cast<size_t>(value) + 1;
+        }
+    };
+    DirectedRootedTree<int> identity_hashed = tree.clone();
+    identity_hashed.enable_structural_hashing(&Hashers::identity);
+    DirectedRootedTree<int> shifted_hashed = tree.clone();
+    shifted_hashed.enable_structural_hashing(&Hashers::shifted);
+    QVERIFY(identity_hashed.root()->structural_hash() != shifted_hashed.root()->structural_hash());
+    QVERIFY(identity_hashed == shifted_hashed);
+    DirectedRootedTree<int> identity_copy(identity_hashed);
+    QVERIFY(identity_copy == identity_hashed);
+    identity_copy.set_value(identity_copy.root(), -1);
+    QVERIFY(identity_copy != identity_hashed);
+
+    DirectedRootedTree<int> moved_tree(std::move(tree));
+    QVERIFY(moved_tree.structural_hashing_enabled());
+    QVERIFY(!tree.structural_hashing_enabled());
+}
+
+void DirectedRootedTreeTest::differing_nodes()
+{
+    std::vector<int> nodes_values;
+    DirectedRootedTree<int> left = build_multilayer_tree(nodes_values);
+    DirectedRootedTree<int> right = build_multilayer_tree(nodes_values);
+    left.enable_structural_hashing();
+    ASSERT_THROWS(tree_algorithms::differing_nodes(left, right), std::logic_error,
+                  "logic_error exception must be thrown when hashing is not enabled");
+    right.enable_structural_hashing();
+    QVERIFY(tree_algorithms::differing_nodes(left, right).empty());
+
+    DirectedRootedTree<int>::TreeNode* changed = right.root()->children()[2]->children()[1].get();
+    right.set_value(changed, 42);
+    DirectedRootedTree<int>::TreeNode* extended = right.root()->children()[0].get();
+    right.add_child(extended, 43);
+
+    typedef const DirectedRootedTree<int>::TreeNode* node_t;
+    std::vector< std::pair<node_t, node_t> > differences = tree_algorithms::differing_nodes(left, right);
+    QCOMPARE(differences.size(), 2ul);
+    QCOMPARE(differences[0].first, static_cast<node_t>(left.root()->children()[0].get()));
+    QCOMPARE(differences[0].second, static_cast<node_t>(extended));
+    QCOMPARE(differences[1].first, static_cast<node_t>(left.root()->children()[2]->children()[1].get()));
+    QCOMPARE(differences[1].second, static_cast<node_t>(changed));
+
+    // Hashes of different hashers cannot be compared
+    struct Hashers
+    {
+        static size_t identity(const int& value)
+        {
+            return static_cast<size_t>(value);
+        }
+    };
+    DirectedRootedTree<int> identity_hashed = right.clone();
+    identity_hashed.enable_structural_hashing(&Hashers::identity);
+    ASSERT_THROWS(tree_algorithms::differing_nodes(left, identity_hashed), std::logic_error,
+                  "logic_error exception must be thrown for trees hashed by different hashers")
+    DirectedRootedTree<int> other_identity_hashed = left.clone();
+    other_identity_hashed.enable_structural_hashing(&Hashers::identity);
+    ASSERT_THROWS(tree_algorithms::differing_nodes(other_identity_hashed, identity_hashed), std::logic_error,
+                  "logic_error exception must be thrown for separately set function pointer hashers")
+}
+
+void DirectedRootedTreeTest::node_metrics()
+{
+    typedef DirectedRootedTree<int>::TreeNode TreeNode;
+
+    DirectedRootedTree<int> tree = build_random_tree(2000, 30, 45);
+    tree.enable_node_metrics();
+
+    // Compares the kept metrics with the ones computed from scratch
+    auto metrics_consistent = [](const DirectedRootedTree<int>& checked_tree)
+    {
+        std::vector<size_t> subtree_sizes;
+        std::vector<size_t> heights;
+        for (DirectedRootedTree<int>::PostorderIterator iter = checked_tree.postorder().begin();
+             iter != checked_tree.postorder().end();
+             ++iter)
+        {
+            const TreeNode* node = iter.current_node();
+            const size_t children_count = node->children().size();
+            size_t subtree_size = 1;
+            size_t height = 0;
+            for (size_t i = heights.size() - children_count; i != heights.size(); ++i)
+            {
+                subtree_size += subtree_sizes[i];
+                height = std::max(height, heights[i] + 1);
+            }
+            subtree_sizes.resize(subtree_sizes.size() - children_count);
+            heights.resize(heights.size() - children_count);
+            subtree_sizes.push_back(subtree_size);
+            heights.push_back(height);
+
+            size_t depth = 0;
+            for (const TreeNode* ancestor = node->parent(); ancestor; ancestor = ancestor->parent())
+            {
+                ++depth;
+            }
+            if (node->depth() != depth || node->subtree_size() != subtree_size || node->height() != height)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    QVERIFY(metrics_consistent(tree));
+    QCOMPARE(tree.root()->subtree_size(), tree.size());
+
+    std::mt19937 generator(9);
+    int next_value = static_cast<int>(tree.size());
+    for (int edit = 0; edit != 200; ++edit)
+    {
+        std::vector<TreeNode*> nodes;
+        for (DirectedRootedTree<int>::Iterator iter = tree.begin(); iter != tree.end(); ++iter)
+        {
+            nodes.push_back(iter.current_node());
+        }
+        std::uniform_int_distribution<size_t> distribution(0, nodes.size() - 1);
+        TreeNode* node = nodes[distribution(generator)];
+        if (edit % 3 != 0 || node == tree.root())
+        {
+            tree.add_child(node, next_value++);
+        }
+        else if (edit % 2 == 0)
+        {
+            tree.remove_node(node);
+        }
+        else
+        {
+            std::vector<TreeNode*> removed(1, node);
+            for (const DirectedRootedTree<int>::node_ptr_t& child : node->children())
+            {
+                removed.push_back(child.get());
+            }
+            tree.remove_nodes(removed);
+        }
+        QVERIFY(metrics_consistent(tree));
+    }
+
+    DirectedRootedTree<int> copy(tree);
+    QVERIFY(copy.node_metrics_enabled());
+    QVERIFY(metrics_consistent(copy));
+    const tree_algorithms::parallel_sequencing_t<int> upper_sequencing = tree_algorithms::upper_parallel_sequencing(copy);
+    copy.disable_node_metrics();
+    QCOMPARE(upper_sequencing, tree_algorithms::upper_parallel_sequencing(copy));
+    QCOMPARE(copy.root()->subtree_size(), size_t(1));
+
+    // Hashes are kept on their own once the metrics are disabled, and the other way round
+    copy.enable_structural_hashing(std::hash<int>());
+    copy.enable_node_metrics();
+    copy.add_child(copy.root(), next_value++);
+    copy.remove_node(copy.root()->children().front().get());
+    QVERIFY(metrics_consistent(copy));
+    copy.disable_node_metrics();
+    copy.add_child(copy.root()->children().back().get(), next_value++);
+    QVERIFY(copy != tree);
+    copy.remove_node(copy.root()->children().back()->children().back().get());
+    QVERIFY(copy.structural_hashing_enabled());
+    DirectedRootedTree<int> rehashed(copy);
+    rehashed.disable_structural_hashing();
+    rehashed.enable_structural_hashing();
+    QCOMPARE(copy.root()->structural_hash(), rehashed.root()->structural_hash());
+    copy.enable_node_metrics();
+    copy.disable_structural_hashing();
+    copy.add_child(copy.root(), next_value++);
+    QVERIFY(metrics_consistent(copy));
+
+    DirectedRootedTree<int> moved(std::move(tree));
+    QVERIFY(moved.node_metrics_enabled());
+    QVERIFY(!tree.node_metrics_enabled());
+}
+
+void DirectedRootedTreeTest::persistent_tree()
+{
+    typedef PersistentDirectedRootedTree<int> PersistentTree;
+
+    const DirectedRootedTree<int> tree = build_random_tree(2000, 30, 47);
+    const PersistentTree version(tree);
+    QCOMPARE(version.size(), tree.size());
+    QVERIFY(version.to_tree() == tree);
+    QCOMPARE(tree_algorithms::lower_parallel_sequencing(version), tree_algorithms::lower_parallel_sequencing(tree));
+    QCOMPARE(tree_algorithms::upper_parallel_sequencing(version), tree_algorithms::upper_parallel_sequencing(tree));
+
+    // Only the path to the edited node is copied
+    const PersistentTree::node_path_t path = { 0, 0 };
+    const PersistentTree added = version.add_child(path, -1);
+    QCOMPARE(added.size(), version.size() + 1);
+    QCOMPARE(added.node(path)->children().back()->value(), -1);
+    QVERIFY(added.root() != version.root());
+    QVERIFY(added.node(path) != version.node(path));
+    QVERIFY(added.root()->children()[1] == version.root()->children()[1]);
+    QVERIFY(added.node({ 0 })->children().back() == version.node({ 0 })->children().back());
+    QVERIFY(version.to_tree() == tree);
+    QVERIFY(added != version);
+
+    DirectedRootedTree<int> edited_tree = tree.clone();
+    DirectedRootedTree<int>::TreeNode* edited_node = edited_tree.root()->children()[0]->children()[0].get();
+    edited_tree.add_child(edited_node, -1);
+    QVERIFY(added.to_tree() == edited_tree);
+
+    // Children of the removed node take its place
+    const PersistentTree removed = added.remove_node(path);
+    edited_tree.remove_node(edited_node);
+    QCOMPARE(removed.size(), version.size());
+    QVERIFY(removed.to_tree() == edited_tree);
+    QCOMPARE(tree_algorithms::upper_parallel_sequencing(removed), tree_algorithms::upper_parallel_sequencing(edited_tree));
+
+    const PersistentTree changed = removed.set_value({ 1 }, 42);
+    QCOMPARE(changed.node({ 1 })->value(), 42);
+    QCOMPARE(changed.size(), removed.size());
+    QVERIFY(changed.node({ 1 })->children() == removed.node({ 1 })->children());
+
+    const PersistentTree snapshot = changed;
+    QVERIFY(snapshot.root() == changed.root());
+    QVERIFY(snapshot == changed);
+    QVERIFY(changed.set_value({ 1 }, removed.node({ 1 })->value()) == removed);
+
+    ASSERT_THROWS(changed.remove_node({}), std::logic_error, "logic_error exception must be thrown on removing the root")
+    ASSERT_THROWS(changed.node({ 0, changed.node({ 0 })->children().size() }), std::out_of_range,
+                  "out_of_range exception must be thrown on a path to a missing node")
+    const DirectedRootedTree<int> moved_tree(std::move(edited_tree));
+    ASSERT_THROWS(PersistentTree rootless_version(edited_tree), std::invalid_argument,
+                  "invalid_argument exception must be thrown on converting a moved-from tree")
+
+    // Deep versions are released without recursion
+    std::vector<int> values(100000);
+    std::vector<size_t> parents(values.size());
+    for (size_t i = 1; i != values.size(); ++i)
+    {
+        values[i] = static_cast<int>(i);
+        parents[i] = i - 1;
+    }
+    PersistentTree deep = PersistentTree::from_preorder(values, parents);
+    const PersistentTree deeper = deep.add_child(PersistentTree::node_path_t(1000, 0), -1);
+    QCOMPARE(deeper.size(), 100001ul);
+    deep = PersistentTree(0);
+    QCOMPARE(deep.size(), 1ul);
+}
+
+void DirectedRootedTreeTest::published_tree()
+{
+    typedef PersistentDirectedRootedTree<int> PersistentTree;
+
+    {
+        PublishedTree<int> published(PersistentTree(0));
+        PublishedTree<int>::Reader reader(published);
+        {
+            PublishedTree<int>::ReadGuard guard = reader.read();
+            for (int i = 1; i != 4; ++i)
+            {
+                published.publish(published.current().add_child(PersistentTree::node_path_t(), i));
+            }
+            // Versions replaced while the guard is alive are kept
+            QCOMPARE(published.retired_count(), 3ul);
+            QCOMPARE(guard->size(), 1ul);
+            PublishedTree<int>::ReadGuard nested_guard = reader.read();
+            QCOMPARE(nested_guard->size(), 4ul);
+        }
+        QCOMPARE(published.reclaim(), 0ul);
+        QCOMPARE(reader.read()->size(), 4ul);
+    }
+
+    // Every version holds a chain of its number of nodes below the root
+    PublishedTree<int> published(PersistentTree(0));
+    const int versions_count = 300;
+    std::atomic<bool> writing(true);
+    std::atomic<int> failures_count(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i != 4; ++i)
+    {
+        readers.emplace_back([&published, &writing, &failures_count]()
+        {
+            PublishedTree<int>::Reader reader(published);
+            int last_version = 0;
+            while (writing.load())
+            {
+                PublishedTree<int>::ReadGuard guard = reader.read();
+                const int version = guard->root()->value();
+                const tree_algorithms::parallel_sequencing_t<int> sequencing =
+                        tree_algorithms::lower_parallel_sequencing(guard.tree());
+                if (version < last_version || guard->size() != static_cast<size_t>(version) + 1 ||
+                    sequencing.size() != static_cast<size_t>(version))
+                {
+                    ++failures_count;
+                }
+                last_version = version;
+            }
+        });
+    }
+
+    PersistentTree version(0);
+    PersistentTree::node_path_t path;
+    for (int i = 1; i <= versions_count; ++i)
+    {
+        version = version.add_child(path, i).set_value(PersistentTree::node_path_t(), i);
+        path.push_back(0);
+        published.publish(version);
+    }
+    writing.store(false);
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    QCOMPARE(failures_count.load(), 0);
+    QCOMPARE(published.reclaim(), 0ul);
+    QCOMPARE(published.epoch(), static_cast<uint64_t>(versions_count));
+    QVERIFY(published.current() == version);
+}
+
+void DirectedRootedTreeTest::concurrent_build()
+{
+    const int threads_count = 4;
+    const int subtree_size = 5000;
+
+    DirectedRootedTree<int> tree(0);
+    tree.enable_structural_hashing();
+    std::vector<DirectedRootedTree<int>::TreeNode*> subtree_roots;
+    for (int i = 0; i != threads_count; ++i)
+    {
+        subtree_roots.push_back(tree.add_child(tree.root(), -1 - i));
+    }
+    tree_algorithms::IncrementalSequencer<int> sequencer(tree);
+
+    {
+        DirectedRootedTree<int>::ConcurrentBuild build(tree);
+        std::vector<std::thread> threads;
+        for (int i = 0; i != threads_count; ++i)
+        {
+            threads.emplace_back([&build, &tree, &subtree_roots, i]()
+            {
+                // Every thread grows its own subtree, and all of them append to the root as well
+                DirectedRootedTree<int>::ConcurrentBuild::Inserter inserter(build);
+                std::mt19937 generator(static_cast<unsigned>(i));
+                std::vector<DirectedRootedTree<int>::TreeNode*> nodes(1, subtree_roots[i]);
+                for (int j = 0; j != subtree_size; ++j)
+                {
+                    std::uniform_int_distribution<size_t> parent_distribution(0, nodes.size() - 1);
+                    nodes.push_back(inserter.add_child(nodes[parent_distribution(generator)], j));
+                    if (j % 10 == 0)
+                    {
+                        inserter.add_child(tree.root(), j);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        build.finish();
+    }
+
+    const size_t expected_size = 1 + threads_count * (1 + subtree_size + subtree_size / 10);
+    QCOMPARE(tree.size(), expected_size);
+    QCOMPARE(static_cast<size_t>(std::distance(tree.cbegin(), tree.cend())), expected_size);
+    QVERIFY(is_tree_consistent(tree));
+    QCOMPARE(tree.root()->children().size(), static_cast<size_t>(threads_count * (1 + subtree_size / 10)));
+
+    DirectedRootedTree<int> copy = tree.clone();
+    copy.enable_structural_hashing();
+    QCOMPARE(tree.root()->structural_hash(), copy.root()->structural_hash());
+    QCOMPARE(sequencer.lower_parallel_sequencing(), tree_algorithms::lower_parallel_sequencing(tree));
+
+    // Nodes from the inserters' pools are owned by the tree, their slots are reused
+    tree.remove_node(subtree_roots.front());
+    QCOMPARE(tree.size(), expected_size - 1);
+    DirectedRootedTree<int>::TreeNode* inserted_leaf = tree.root()->children().back().get();
+    QVERIFY(inserted_leaf->children().empty());
+    tree.remove_node(inserted_leaf);
+    QCOMPARE(tree.add_child(tree.root(), 42), inserted_leaf);
+    QCOMPARE(tree.size(), expected_size - 1);
+    DirectedRootedTree<int> moved(std::move(tree));
+    QCOMPARE(moved.size(), expected_size - 1);
+
+    // A session left without finish() keeps its nodes, the aggregates which could not be updated are dropped
+    moved.enable_node_metrics();
+    {
+        DirectedRootedTree<int>::ConcurrentBuild build(moved);
+        DirectedRootedTree<int>::ConcurrentBuild::Inserter inserter(build);
+        inserter.add_child(moved.root(), 43);
+    }
+    QCOMPARE(moved.size(), expected_size);
+    QVERIFY(!moved.structural_hashing_enabled());
+    QVERIFY(!moved.node_metrics_enabled());
+    QVERIFY(is_tree_consistent(moved));
+}
+
+void DirectedRootedTreeTest::cache_line_aligned()
+{
+    struct Counter : CacheLineAligned
+    {
+        std::atomic<int> value;
+    };
+    static_assert(sizeof(Counter) == CacheLineAligned::cache_line_size, "Counter must fill one cache line");
+
+    // Heap objects are aligned by the base, also where operator new ignores the alignment of the type
+    std::unique_ptr<Counter[]> counters(new Counter[5]);
+    for (size_t i = 0; i != 5; ++i)
+    {
+        QCOMPARE(reinterpret_cast<uintptr_t>(&counters[i]) % CacheLineAligned::cache_line_size, uintptr_t(0));
+    }
+    std::unique_ptr<Counter> counter(new Counter());
+    QCOMPARE(reinterpret_cast<uintptr_t>(counter.get()) % CacheLineAligned::cache_line_size, uintptr_t(0));
+}
+
+void DirectedRootedTreeTest::flat_tree_conversion()
+{
+    std::vector<int> nodes_values;
+    DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    FlatDirectedRootedTree<int> flat_tree(tree);
+    QCOMPARE(flat_tree.size(), nodes_values.size());
+    QVERIFY(std::equal(flat_tree.begin(), flat_tree.end(), nodes_values.begin()));
+
+    // Converted tree is laid out in preorder
+    size_t index = 0;
+    for (FlatDirectedRootedTree<int>::Iterator iter = flat_tree.begin(); iter != flat_tree.end(); ++iter)
+    {
+        QCOMPARE(iter.current_node(), index++);
+    }
+
+    DirectedRootedTree<int> converted_tree = flat_tree.to_tree();
+    QVERIFY(is_tree_consistent(converted_tree));
+    QVERIFY(converted_tree == tree);
+    QCOMPARE(converted_tree.root()->children().size(), 3ul);
+}
+
+void DirectedRootedTreeTest::flat_tree_remove_node()
+{
+    std::vector<int> nodes_values;
+    DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+    FlatDirectedRootedTree<int> flat_tree(tree);
+
+    ASSERT_THROWS(flat_tree.remove_node(flat_tree.root()), std::logic_error,
+                  "logic_error exception must be thrown on removing the root node");
+
+    FlatDirectedRootedTree<int>::node_index_t second = flat_tree.next_sibling(flat_tree.first_child(flat_tree.root()));
+    flat_tree.remove_node(second);
+    nodes_values.erase(nodes_values.begin() + 4);
+    QCOMPARE(flat_tree.size(), nodes_values.size());
+    QVERIFY(std::equal(flat_tree.begin(), flat_tree.end(), nodes_values.begin()));
+
+    tree.remove_node(tree.root()->children()[1].get());
+    DirectedRootedTree<int> converted_tree = flat_tree.to_tree();
+    QVERIFY(converted_tree == tree);
+
+    FlatDirectedRootedTree<int>::node_index_t added = flat_tree.add_child(flat_tree.root(), 7);
+    QCOMPARE(added, second);
+    nodes_values.push_back(7);
+    QVERIFY(std::equal(flat_tree.begin(), flat_tree.end(), nodes_values.begin()));
+
+    flat_tree.compact();
+    QCOMPARE(flat_tree.size(), nodes_values.size());
+    QVERIFY(std::equal(flat_tree.begin(), flat_tree.end(), nodes_values.begin()));
+    QCOMPARE(flat_tree.value(nodes_values.size() - 1), 7);
+
+    // A value which fails to copy leaves the tree unchanged
+    struct Fragile
+    {
+        Fragile(int value = 0)
+            : value(value)
+        {
+
+        }
+
+        Fragile(const Fragile& other)
+            : value(other.value)
+        {
+            if (value < 0)
+            {
+                throw std::runtime_error("Negative value");
+            }
+        }
+
+        Fragile& operator=(const Fragile& other)
+        {
+            if (other.value < 0)
+            {
+                throw std::runtime_error("Negative value");
+            }
+            value = other.value;
+            return *this;
+        }
+
+        int value;
+    };
+    FlatDirectedRootedTree<Fragile> fragile_tree(Fragile(0));
+    FlatDirectedRootedTree<Fragile>::node_index_t removed = fragile_tree.add_child(fragile_tree.root(), Fragile(1));
+    const Fragile broken(-1);
+    ASSERT_THROWS(fragile_tree.add_child(fragile_tree.root(), broken), std::runtime_error,
+                  "runtime_error exception must be thrown by the copied value")
+    QCOMPARE(fragile_tree.size(), 2ul);
+    fragile_tree.remove_node(removed);
+    ASSERT_THROWS(fragile_tree.add_child(fragile_tree.root(), broken), std::runtime_error,
+                  "runtime_error exception must be thrown by the assigned value")
+    QCOMPARE(fragile_tree.size(), 1ul);
+    QVERIFY(fragile_tree.first_child(fragile_tree.root()) == FlatDirectedRootedTree<Fragile>::invalid_index);
+    QCOMPARE(fragile_tree.add_child(fragile_tree.root(), Fragile(2)), removed);
+    QCOMPARE(fragile_tree.value(removed).value, 2);
+}
+
+void DirectedRootedTreeTest::graph_tree_conversion()
+{
+    const DirectedRootedTree<int> tree = build_random_tree(3000, 20, 19);
+    const DirectedAcyclicGraph<int> graph(tree);
+    QCOMPARE(graph.size(), tree.size());
+    QCOMPARE(graph.edges_count(), tree.size() - 1);
+    size_t index = 0;
+    for (DirectedRootedTree<int>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter, ++index)
+    {
+        QCOMPARE(graph.value(index), *iter);
+    }
+    QVERIFY(graph.predecessors(0).empty());
+    QCOMPARE(graph.successors(0).size(), tree.root()->children().size());
+
+    tree_algorithms::parallel_sequencing_t<int> lower = tree_algorithms::lower_parallel_sequencing(tree);
+    lower.insert(lower.begin(), std::vector<int>(1, tree.root()->value()));
+    QCOMPARE(tree_algorithms::lower_parallel_sequencing(graph), lower);
+
+    tree_algorithms::parallel_sequencing_t<int> upper = tree_algorithms::upper_parallel_sequencing(tree);
+    upper.push_back(std::vector<int>(1, tree.root()->value()));
+    QCOMPARE(tree_algorithms::upper_parallel_sequencing(graph), upper);
+}
+
+void DirectedRootedTreeTest::graph_sequencing()
+{
+    // Nodes 3, 5 and 7 have several prerequisites, 0 -> 7 is shorter than the other paths to 7
+    std::vector<DirectedAcyclicGraph<int>::edge_t> edges = {
+        { 0, 2 }, { 0, 3 }, { 1, 3 }, { 1, 4 }, { 2, 5 }, { 3, 5 }, { 4, 6 }, { 5, 7 }, { 6, 7 }, { 0, 7 }
+    };
+    const DirectedAcyclicGraph<int> graph({ 0, 1, 2, 3, 4, 5, 6, 7 }, edges);
+    QCOMPARE(graph.edges_count(), edges.size());
+    QVERIFY(std::equal(graph.predecessors(7).begin(), graph.predecessors(7).end(), std::vector<size_t>({ 5, 6, 0 }).begin()));
+    QVERIFY(std::equal(graph.successors(0).begin(), graph.successors(0).end(), std::vector<size_t>({ 2, 3, 7 }).begin()));
+
+    tree_algorithms::parallel_sequencing_t<int> lower = { { 0, 1 }, { 2, 3, 4 }, { 5, 6 }, { 7 } };
+    QCOMPARE(tree_algorithms::lower_parallel_sequencing(graph), lower);
+    tree_algorithms::parallel_sequencing_t<int> upper = { { 7 }, { 5, 6 }, { 2, 3, 4 }, { 0, 1 } };
+    QCOMPARE(tree_algorithms::upper_parallel_sequencing(graph), upper);
+
+    std::vector<size_t> order = tree_algorithms::topological_order(graph);
+    QCOMPARE(order.size(), graph.size());
+    std::vector<size_t> positions(graph.size());
+    for (size_t i = 0; i != order.size(); ++i)
+    {
+        positions[order[i]] = i;
+    }
+    for (const DirectedAcyclicGraph<int>::edge_t& edge : edges)
+    {
+        QVERIFY(positions[edge.first] < positions[edge.second]);
+    }
+
+    QVERIFY(tree_algorithms::lower_parallel_sequencing(DirectedAcyclicGraph<int>()).empty());
+}
+
+void DirectedRootedTreeTest::graph_cycle_detection()
+{
+    std::vector<DirectedAcyclicGraph<int>::edge_t> edges = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 1 }, { 3, 4 } };
+    QCOMPARE(DirectedAcyclicGraph<int>::find_cycle(5, edges), std::vector<size_t>({ 1, 2, 3 }));
+    ASSERT_THROWS(DirectedAcyclicGraph<int>(std::vector<int>(5), edges), std::invalid_argument,
+                  "invalid_argument exception must be thrown on a cyclic graph");
+
+    edges.pop_back();
+    edges[3] = { 3, 3 };
+    QCOMPARE(DirectedAcyclicGraph<int>::find_cycle(4, edges), std::vector<size_t>({ 3 }));
+
+    edges[3] = { 0, 3 };
+    QVERIFY(DirectedAcyclicGraph<int>::find_cycle(4, edges).empty());
+    ASSERT_THROWS(DirectedAcyclicGraph<int>(std::vector<int>(3), edges), std::out_of_range,
+                  "out_of_range exception must be thrown on an edge to a missing node");
+}
+
+void DirectedRootedTreeTest::algo_node_sequencing()
+{
+    std::vector<int> nodes_values;
+    const DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    tree_algorithms::NodeSequencing<int> lower = tree_algorithms::lower_node_sequencing(tree);
+    QCOMPARE(lower.levels_count(), 3ul);
+    QCOMPARE(lower.nodes().size(), tree.size() - 1);
+    QCOMPARE(lower.level_size(0), 3ul);
+    QVERIFY(std::equal(lower.level_begin(0), lower.level_end(0), tree_algorithms::top_leaf_nodes(tree).begin()));
+    QCOMPARE(lower.values(), tree_algorithms::lower_parallel_sequencing(tree));
+
+    tree_algorithms::NodeSequencing<int> upper = tree_algorithms::upper_node_sequencing(tree);
+    QCOMPARE(upper.levels_count(), 3ul);
+    QCOMPARE(upper.level_offsets(), std::vector<size_t>({ 0, 10, 16, 19 }));
+    QVERIFY(std::equal(upper.level_begin(0), upper.level_end(0), tree_algorithms::bottom_leaf_nodes(tree).begin()));
+    QCOMPARE(upper.values(), tree_algorithms::upper_parallel_sequencing(tree));
+
+    const DirectedRootedTree<int> random_tree = build_random_tree(5000, 30, 7);
+    QCOMPARE(tree_algorithms::lower_node_sequencing(random_tree).values(),
+             tree_algorithms::lower_parallel_sequencing(random_tree));
+    QCOMPARE(tree_algorithms::upper_node_sequencing(random_tree).values(),
+             tree_algorithms::upper_parallel_sequencing(random_tree));
+
+    const DirectedRootedTree<int> single(0);
+    QCOMPARE(tree_algorithms::lower_node_sequencing(single).levels_count(), 0ul);
+    QCOMPARE(tree_algorithms::upper_node_sequencing(single).levels_count(), 0ul);
+}
+
+void DirectedRootedTreeTest::algo_slack_windows()
+{
+    DirectedRootedTree<int> tree(0);
+    DirectedRootedTree<int>::TreeNode* a = tree.add_child(tree.root(), 1);
+    DirectedRootedTree<int>::TreeNode* d = tree.add_child(tree.root(), 2);
+    DirectedRootedTree<int>::TreeNode* b = tree.add_child(a, 3);
+    DirectedRootedTree<int>::TreeNode* c = tree.add_child(b, 4);
+    DirectedRootedTree<int>::TreeNode* e = tree.add_child(a, 5);
+
+    std::vector< tree_algorithms::SlackWindow<int> > windows = tree_algorithms::slack_windows(tree);
+    QCOMPARE(windows.size(), 5ul);
+
+    std::vector<const DirectedRootedTree<int>::TreeNode*> expected_nodes = { a, b, c, e, d };
+    std::vector<size_t> expected_earliest = { 0, 1, 2, 1, 0 };
+    std::vector<size_t> expected_latest = { 0, 1, 2, 2, 2 };
+    for (size_t i = 0; i != windows.size(); ++i)
+    {
+        QCOMPARE(windows[i].node, expected_nodes[i]);
+        QCOMPARE(windows[i].earliest_column, expected_earliest[i]);
+        QCOMPARE(windows[i].latest_column, expected_latest[i]);
+    }
+
+    // Windows agree with both sequencings
+    const DirectedRootedTree<int> random_tree = build_random_tree(3000, 20, 11);
+    tree_algorithms::parallel_sequencing_t<int> lower = tree_algorithms::lower_parallel_sequencing(random_tree);
+    tree_algorithms::parallel_sequencing_t<int> upper = tree_algorithms::upper_parallel_sequencing(random_tree);
+    std::vector<size_t> lower_columns(random_tree.size()), upper_columns(random_tree.size());
+    for (size_t column = 0; column != lower.size(); ++column)
+    {
+        for (int value : lower[column])
+        {
+            lower_columns[value] = column;
+        }
+        for (int value : upper[column])
+        {
+            upper_columns[value] = lower.size() - 1 - column;
+        }
+    }
+    for (const tree_algorithms::SlackWindow<int>& window : tree_algorithms::slack_windows(random_tree))
+    {
+        QCOMPARE(window.earliest_column, lower_columns[window.node->value()]);
+        QCOMPARE(window.latest_column, upper_columns[window.node->value()]);
+    }
+
+    QVERIFY(tree_algorithms::slack_windows(DirectedRootedTree<int>(0)).empty());
+}
+
+void DirectedRootedTreeTest::algo_lazy_sequencing()
+{
+    std::vector<int> nodes_values;
+    const DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+    const tree_algorithms::parallel_sequencing_t<int> expected = tree_algorithms::lower_parallel_sequencing(tree);
+
+    tree_algorithms::parallel_sequencing_t<int> columns;
+    for (const std::vector<int>& column : tree_algorithms::lazy_lower_parallel_sequencing(tree))
+    {
+        columns.push_back(column);
+    }
+    QCOMPARE(columns, expected);
+
+    // Postfix increment gives the column before the increment
+    tree_algorithms::LowerSequencingGenerator<int> postfix_generator = tree_algorithms::lazy_lower_parallel_sequencing(tree);
+    columns.clear();
+    for (tree_algorithms::LowerSequencingGenerator<int>::Iterator iter = postfix_generator.begin();
+         iter != postfix_generator.end();)
+    {
+        columns.push_back(*iter++);
+    }
+    QCOMPARE(columns, expected);
+    tree_algorithms::LowerSequencingGenerator<int>::Iterator end_iter = postfix_generator.end();
+    ASSERT_THROWS(end_iter++, std::out_of_range, "out_of_range exception must be thrown on incrementing the end")
+
+    // Only pulled columns are computed
+    tree_algorithms::LowerSequencingGenerator<int> generator = tree_algorithms::lazy_lower_parallel_sequencing(tree);
+    QVERIFY(generator.next());
+    QCOMPARE(generator.column(), expected[0]);
+    QVERIFY(generator.next());
+    QCOMPARE(generator.column(), expected[1]);
+    QVERIFY(generator.next());
+    QVERIFY(!generator.next());
+    QVERIFY(generator.done());
+    QVERIFY(generator.begin() == generator.end());
+
+    const DirectedRootedTree<int> single(0);
+    tree_algorithms::LowerSequencingGenerator<int> empty_generator = tree_algorithms::lazy_lower_parallel_sequencing(single);
+    QVERIFY(empty_generator.begin() == empty_generator.end());
+}
+
+void DirectedRootedTreeTest::algo_incremental_sequencing()
+{
+    DirectedRootedTree<int> tree = build_random_tree(2000, 25, 3);
+    tree_algorithms::IncrementalSequencer<int> sequencer(tree);
+    QCOMPARE(sequencer.lower_parallel_sequencing(), tree_algorithms::lower_parallel_sequencing(tree));
+    QCOMPARE(sequencer.upper_parallel_sequencing(), tree_algorithms::upper_parallel_sequencing(tree));
+
+    // Order inside of the columns is not kept by the edits
+    auto sorted = [](tree_algorithms::parallel_sequencing_t<int> parallel_sequencing)
+    {
+        for (std::vector<int>& column : parallel_sequencing)
+        {
+            std::sort(column.begin(), column.end());
+        }
+        return parallel_sequencing;
+    };
+
+    std::mt19937 generator(5);
+    int next_value = static_cast<int>(tree.size());
+    for (int edit = 0; edit != 300; ++edit)
+    {
+        std::vector<DirectedRootedTree<int>::TreeNode*> nodes;
+        for (DirectedRootedTree<int>::Iterator iter = tree.begin(); iter != tree.end(); ++iter)
+        {
+            nodes.push_back(iter.current_node());
+        }
+        std::uniform_int_distribution<size_t> distribution(1, nodes.size() - 1);
+        if (edit % 50 == 49)
+        {
+            std::vector<DirectedRootedTree<int>::TreeNode*> removed_nodes;
+            for (int i = 0; i != 20; ++i)
+            {
+                removed_nodes.push_back(nodes[distribution(generator)]);
+            }
+            tree.remove_nodes(removed_nodes);
+        }
+        else if (edit % 3 == 0)
+        {
+            tree.remove_node(nodes[distribution(generator)]);
+        }
+        else
+        {
+            tree.add_child(nodes[distribution(generator) - 1], next_value++);
+        }
+        QCOMPARE(sorted(sequencer.lower_parallel_sequencing()), sorted(tree_algorithms::lower_parallel_sequencing(tree)));
+        QCOMPARE(sorted(sequencer.upper_parallel_sequencing()), sorted(tree_algorithms::upper_parallel_sequencing(tree)));
+    }
+
+    const DirectedRootedTree<int>::TreeNode* leaf = tree.root();
+    size_t leaf_depth = 0;
+    while (!leaf->children().empty())
+    {
+        leaf = leaf->children().back().get();
+        ++leaf_depth;
+    }
+    QCOMPARE(sequencer.depth(leaf), leaf_depth);
+    QCOMPARE(sequencer.height(leaf), 0ul);
+    QVERIFY(std::find(sequencer.upper_level(0).begin(), sequencer.upper_level(0).end(), leaf) != sequencer.upper_level(0).end());
+
+    // Moving the nodes out of the tree empties the sequencer
+    DirectedRootedTree<int> moved_tree(std::move(tree));
+    QCOMPARE(sequencer.lower_levels_count(), 0ul);
+    QCOMPARE(sequencer.upper_levels_count(), 0ul);
+
+    tree = std::move(moved_tree);
+    QCOMPARE(sequencer.lower_parallel_sequencing(), tree_algorithms::lower_parallel_sequencing(tree));
+    QCOMPARE(sequencer.upper_parallel_sequencing(), tree_algorithms::upper_parallel_sequencing(tree));
+}
+
+void DirectedRootedTreeTest::algo_bounded_sequencing()
+{
+    typedef const DirectedRootedTree<int>::TreeNode* node_t;
+
+    std::vector<int> nodes_values;
+    const DirectedRootedTree<int> tree = build_multilayer_tree(nodes_values);
+
+    // Wide enough stages are the levels of the unbounded sequencings
+    QCOMPARE(tree_algorithms::upper_bounded_sequencing(tree, tree.size()).levels_count(), 3ul);
+    QCOMPARE(tree_algorithms::upper_bounded_sequencing(tree, 1).levels_count(), tree.size() - 1);
+    QCOMPARE(tree_algorithms::upper_bounded_sequencing(tree, 4).levels_count(), 5ul);
+    QVERIFY(tree_algorithms::upper_bounded_sequencing(DirectedRootedTree<int>(0), 3).nodes().empty());
+
+    const DirectedRootedTree<int> random_tree = build_random_tree(200000, 50, 13);
+    const size_t height = tree_algorithms::upper_node_sequencing(random_tree).levels_count();
+    for (size_t width : { 1ul, 3ul, 64ul, 100000ul })
+    {
+        tree_algorithms::NodeSequencing<int> upper = tree_algorithms::upper_bounded_sequencing(random_tree, width);
+        tree_algorithms::NodeSequencing<int> lower = tree_algorithms::lower_bounded_sequencing(random_tree, width);
+        QCOMPARE(upper.nodes().size(), random_tree.size() - 1);
+        QCOMPARE(lower.levels_count(), upper.levels_count());
+        QVERIFY(upper.levels_count() >= std::max(height, (random_tree.size() - 2) / width + 1));
+
+        std::vector<size_t> upper_stages(random_tree.size(), 0), lower_stages(random_tree.size(), 0);
+        for (size_t stage = 0; stage != upper.levels_count(); ++stage)
+        {
+            QVERIFY(upper.level_size(stage) <= width);
+            for (auto iter = upper.level_begin(stage); iter != upper.level_end(stage); ++iter)
+            {
+                upper_stages[(*iter)->value()] = stage + 1;
+            }
+            for (auto iter = lower.level_begin(stage); iter != lower.level_end(stage); ++iter)
+            {
+                lower_stages[(*iter)->value()] = stage + 1;
+            }
+        }
+        for (node_t node : upper.nodes())
+        {
+            if (node->parent() != random_tree.root())
+            {
+                QVERIFY(upper_stages[node->value()] < upper_stages[node->parent()->value()]);
+                QVERIFY(lower_stages[node->value()] > lower_stages[node->parent()->value()]);
+            }
+        }
+    }
+    QCOMPARE(tree_algorithms::upper_bounded_sequencing(random_tree, random_tree.size()).levels_count(), height);
+
+    ASSERT_THROWS(tree_algorithms::upper_bounded_sequencing(tree, 0), std::invalid_argument,
+                  "Zero width stages must be rejected");
+}
+
+void DirectedRootedTreeTest::algo_weighted_schedule()
+{
+    DirectedRootedTree<int> tree(0);
+    DirectedRootedTree<int>::TreeNode* a = tree.add_child(tree.root(), 2);
+    tree.add_child(tree.root(), 3);
+    tree.add_child(a, 1);
+    tree.add_child(a, 5);
+
+    tree_algorithms::WeightedSchedule<int> schedule = tree_algorithms::weighted_schedule(tree, [](int value)
+    {
+        return static_cast<double>(value);
+    });
+    QCOMPARE(schedule.nodes.size(), 4ul);
+    QCOMPARE(schedule.nodes.front(), static_cast<const DirectedRootedTree<int>::TreeNode*>(a));
+    QCOMPARE(schedule.parents, std::vector<size_t>({ tree_algorithms::no_parent_index, 0, 0, tree_algorithms::no_parent_index }));
+    QCOMPARE(schedule.earliest_starts, std::vector<double>({ 0, 2, 2, 0 }));
+    QCOMPARE(schedule.latest_starts, std::vector<double>({ 0, 6, 2, 4 }));
+    QCOMPARE(schedule.critical_path, std::vector<size_t>({ 0, 2 }));
+    QCOMPARE(schedule.duration, 7.0);
+
+    // Unit weights give the slack windows
+    const DirectedRootedTree<int> random_tree = build_random_tree(3000, 20, 17);
+    tree_algorithms::WeightedSchedule<int> unit_schedule = tree_algorithms::weighted_schedule(random_tree, [](int)
+    {
+        return 1.0;
+    });
+    std::vector< tree_algorithms::SlackWindow<int> > windows = tree_algorithms::slack_windows(random_tree);
+    QCOMPARE(unit_schedule.duration, static_cast<double>(tree_algorithms::upper_node_sequencing(random_tree).levels_count()));
+    QCOMPARE(unit_schedule.critical_path.size(), tree_algorithms::lower_node_sequencing(random_tree).levels_count());
+    for (size_t node = 0; node != windows.size(); ++node)
+    {
+        QCOMPARE(unit_schedule.nodes[node], windows[node].node);
+        QCOMPARE(unit_schedule.earliest_starts[node], static_cast<double>(windows[node].earliest_column));
+        QCOMPARE(unit_schedule.latest_starts[node], static_cast<double>(windows[node].latest_column));
+    }
+
+    QVERIFY(tree_algorithms::weighted_schedule(DirectedRootedTree<int>(0), [](int) { return 1.0; }).nodes.empty());
+}
+
+void DirectedRootedTreeTest::algo_sequencing_cache()
+{
+    const DirectedRootedTree<int> tree = build_random_tree(500, 10, 31);
+    const DirectedRootedTree<int> same_tree = build_random_tree(500, 10, 31);
+    const DirectedRootedTree<int> other_tree = build_random_tree(500, 10, 37);
+    const DirectedRootedTree<int> third_tree = build_random_tree(300, 10, 41);
+
+    tree_algorithms::SequencingCache<int> cache(2);
+    tree_algorithms::SequencingCache<int>::sequencing_ptr_t lower = cache.lower_parallel_sequencing(tree);
+    QCOMPARE(*lower, tree_algorithms::lower_parallel_sequencing(tree));
+    QCOMPARE(cache.misses(), 1ul);
+
+    // Structurally identical tree shares the cached result
+    QCOMPARE(cache.lower_parallel_sequencing(same_tree), lower);
+    QCOMPARE(cache.hits(), 1ul);
+    QCOMPARE(*cache.upper_parallel_sequencing(same_tree), tree_algorithms::upper_parallel_sequencing(tree));
+    QCOMPARE(cache.misses(), 2ul);
+    QCOMPARE(cache.size(), 1ul);
+
+    QCOMPARE(*cache.lower_parallel_sequencing(other_tree), tree_algorithms::lower_parallel_sequencing(other_tree));
+    QCOMPARE(*cache.lower_parallel_sequencing(third_tree), tree_algorithms::lower_parallel_sequencing(third_tree));
+    QCOMPARE(cache.size(), 2ul);
+    QCOMPARE(cache.evictions(), 1ul);
+    QVERIFY(cache.lower_parallel_sequencing(tree) != lower);
+    QCOMPARE(cache.misses(), 5ul);
+    QCOMPARE(cache.evictions(), 2ul);
+
+    // Hash collisions are detected by comparing the trees
+    tree_algorithms::SequencingCache<int> colliding_cache(4, [](int) -> size_t { return 0; });
+    DirectedRootedTree<int> shifted_tree(0);
+    for (const DirectedRootedTree<int>::node_ptr_t& child : other_tree.root()->children())
+    {
+        shifted_tree.add_child(shifted_tree.root(), child->value() + 1);
+    }
+    DirectedRootedTree<int> flat_tree(0);
+    for (const DirectedRootedTree<int>::node_ptr_t& child : other_tree.root()->children())
+    {
+        flat_tree.add_child(flat_tree.root(), child->value());
+    }
+    QCOMPARE(*colliding_cache.lower_parallel_sequencing(flat_tree), tree_algorithms::lower_parallel_sequencing(flat_tree));
+    QCOMPARE(*colliding_cache.lower_parallel_sequencing(shifted_tree), tree_algorithms::lower_parallel_sequencing(shifted_tree));
+    QCOMPARE(*colliding_cache.lower_parallel_sequencing(flat_tree), tree_algorithms::lower_parallel_sequencing(flat_tree));
+    QCOMPARE(colliding_cache.hits(), 0ul);
+    QCOMPARE(colliding_cache.misses(), 3ul);
+
+    // Hashed trees are found by their root hash: a hit hashes no values, unlike a computed sequencing
+    size_t hashed_values_count = 0;
+    tree_algorithms::SequencingCache<int> counting_cache(4, [&hashed_values_count](const int& value) -> size_t
+    {
+        ++hashed_values_count;
+        return std::hash<int>()(value);
+    });
+    DirectedRootedTree<int> hashed_tree = tree.clone();
+    hashed_tree.enable_structural_hashing();
+    DirectedRootedTree<int> hashed_same_tree = same_tree.clone();
+    hashed_same_tree.enable_structural_hashing();
+    lower = counting_cache.lower_parallel_sequencing(hashed_tree);
+    QCOMPARE(*lower, tree_algorithms::lower_parallel_sequencing(tree));
+    QCOMPARE(counting_cache.lower_parallel_sequencing(hashed_same_tree), lower);
+    QCOMPARE(counting_cache.hits(), 1ul);
+    QCOMPARE(hashed_values_count, 0ul);
+    QVERIFY(counting_cache.lower_parallel_sequencing(tree) != lower);
+    QCOMPARE(hashed_values_count, tree.size());
+
+    hashed_same_tree.set_value(hashed_same_tree.root()->children().front().get(), -1);
+    QCOMPARE(*counting_cache.lower_parallel_sequencing(hashed_same_tree),
+             tree_algorithms::lower_parallel_sequencing(hashed_same_tree));
+    QCOMPARE(counting_cache.hits(), 1ul);
+
+    // Equal hashes of another hasher are not taken as the same tree
+    DirectedRootedTree<int> other_hasher_tree = tree.clone();
+    other_hasher_tree.enable_structural_hashing([](const int& value) -> size_t
+    {
+        return std::hash<int>()(value);
+    });
+    QCOMPARE(other_hasher_tree.root()->structural_hash(), hashed_tree.root()->structural_hash());
+    QVERIFY(counting_cache.lower_parallel_sequencing(other_hasher_tree) != lower);
+    QCOMPARE(counting_cache.hits(), 1ul);
+    QCOMPARE(counting_cache.size(), 4ul);
+
+    // Colliding root hashes of one hasher are detected by comparing the trees as well
+    DirectedRootedTree<int> hashed_flat_tree = flat_tree.clone();
+    hashed_flat_tree.enable_structural_hashing([](const int&) -> size_t { return 0; });
+    DirectedRootedTree<int> hashed_shifted_tree = hashed_flat_tree.clone();
+    hashed_shifted_tree.set_value(hashed_shifted_tree.root()->children().front().get(), -1);
+    QCOMPARE(hashed_shifted_tree.root()->structural_hash(), hashed_flat_tree.root()->structural_hash());
+    QCOMPARE(*counting_cache.lower_parallel_sequencing(hashed_flat_tree),
+             tree_algorithms::lower_parallel_sequencing(hashed_flat_tree));
+    QCOMPARE(*counting_cache.lower_parallel_sequencing(hashed_shifted_tree),
+             tree_algorithms::lower_parallel_sequencing(hashed_shifted_tree));
+    QCOMPARE(counting_cache.hits(), 1ul);
+
+    tree_algorithms::SequencingCache<int> disabled_cache(0);
+    disabled_cache.lower_parallel_sequencing(tree);
+    QCOMPARE(disabled_cache.size(), 0ul);
+}
+
+void DirectedRootedTreeTest::algo_multithreaded_sequencing_data()
+{
+    QTest::addColumn<int>("nodes_count");
+    QTest::addColumn<int>("max_parent_distance");
+    QTest::addColumn<int>("threads_count");
+
+    QTest::newRow("wide") << 20000 << 20000 << 4;
+    QTest::newRow("deep") << 20000 << 3 << 4;
+    QTest::newRow("mixed") << 50000 << 100 << 3;
+    QTest::newRow("chain") << 5000 << 1 << 2;
+    QTest::newRow("single") << 1 << 1 << 2;
+}
+
+void DirectedRootedTreeTest::algo_multithreaded_sequencing()
+{
+    QFETCH(int, nodes_count);
+    QFETCH(int, max_parent_distance);
+    QFETCH(int, threads_count);
+
+    const DirectedRootedTree<int> tree = build_random_tree(nodes_count, max_parent_distance, 42);
+    const tree_algorithms::parallel_options options(threads_count, 0);
+
+    QCOMPARE(tree_algorithms::lower_parallel_sequencing(tree, options),
+             tree_algorithms::lower_parallel_sequencing(tree));
+    QCOMPARE(tree_algorithms::upper_parallel_sequencing(tree, options),
+             tree_algorithms::upper_parallel_sequencing(tree));
+
+    // Values are only copied, as by the serial functions
+    struct Label
+    {
+        explicit Label(int value)
+            : value(value)
+        {
+
+        }
+
+        bool operator==(const Label& other) const
+        {
+            return value == other.value;
+        }
+
+        const int value;
+    };
+    DirectedRootedTree<Label> labels(Label(tree.root()->value()));
+    std::vector< std::pair<const DirectedRootedTree<int>::TreeNode*, DirectedRootedTree<Label>::TreeNode*> > pending(
+                1, std::make_pair(tree.root(), labels.root()));
+    while (!pending.empty())
+    {
+        const std::pair<const DirectedRootedTree<int>::TreeNode*, DirectedRootedTree<Label>::TreeNode*> nodes = pending.back();
+        pending.pop_back();
+        for (const DirectedRootedTree<int>::node_ptr_t& child : nodes.first->children())
+        {
+            pending.emplace_back(child.get(), labels.add_child(nodes.second, Label(child->value())));
+        }
+    }
+    QVERIFY(tree_algorithms::lower_parallel_sequencing(labels, options) == tree_algorithms::lower_parallel_sequencing(labels));
+    QVERIFY(tree_algorithms::upper_parallel_sequencing(labels, options) == tree_algorithms::upper_parallel_sequencing(labels));
+}
+
+void DirectedRootedTreeTest::algo_parallel_for_each_data()
+{
+    algo_multithreaded_sequencing_data();
+}
+
+void DirectedRootedTreeTest::algo_parallel_for_each()
+{
+    QFETCH(int, nodes_count);
+    QFETCH(int, max_parent_distance);
+    QFETCH(int, threads_count);
+
+    DirectedRootedTree<int> tree = build_random_tree(nodes_count, max_parent_distance, 43);
+    const tree_algorithms::parallel_options options(threads_count, 0);
+
+    std::vector<int> doubled_values;
+    for (int value : tree)
+    {
+        doubled_values.push_back(2 * value);
+    }
+
+    // Hashes and companion indexes see the values changed in place
+    DirectedRootedTree<int> set_tree = tree.clone();
+    set_tree.enable_structural_hashing();
+    for (DirectedRootedTree<int>::Iterator iter = set_tree.begin(); iter != set_tree.end(); ++iter)
+    {
+        set_tree.set_value(iter.current_node(), 2 * *iter);
+    }
+    tree.enable_structural_hashing();
+    tree_algorithms::ValueIndex<int> index(tree);
+
+    tree_algorithms::parallel_for_each(tree, [](int& value)
+    {
+        value *= 2;
+    }, options);
+    QVERIFY(std::equal(tree.cbegin(), tree.cend(), doubled_values.begin()));
+    QCOMPARE(tree.root()->structural_hash(), set_tree.root()->structural_hash());
+    QVERIFY(tree == set_tree);
+    if (tree.size() > 1)
+    {
+        // The first node after the root had the value 1, no value is odd any more
+        QCOMPARE(index.find(2), tree.root()->children().front().get());
+        QVERIFY(!index.contains(1));
+    }
+
+    std::atomic<long long> visited_sum(0);
+    const DirectedRootedTree<int>& const_tree = tree;
+    tree_algorithms::parallel_for_each(const_tree, [&visited_sum](const int& value)
+    {
+        visited_sum += value;
+    }, options);
+    const long long sum = std::accumulate(doubled_values.begin(), doubled_values.end(), 0ll);
+    QCOMPARE(visited_sum.load(), sum);
+
+    QCOMPARE(tree_algorithms::parallel_reduce(const_tree, 0ll, [](long long left, long long right)
+    {
+        return left + right;
+    }, options), sum);
+
+    // Chunk results are combined in preorder
+    typedef std::vector<int> values_t;
+    const values_t preorder_values = tree_algorithms::parallel_reduce(const_tree, values_t(),
+                                                                      [](values_t values, int value)
+    {
+        values.push_back(value);
+        return values;
+    },
+                                                                      [](values_t left, const values_t& right)
+    {
+        left.insert(left.end(), right.begin(), right.end());
+        return left;
+    }, options);
+    QCOMPARE(preorder_values, doubled_values);
+
+    ASSERT_THROWS(tree_algorithms::parallel_for_each(const_tree, [](int value)
+    {
+        if (value == 0)
+        {
+            throw std::runtime_error("Zero value");
+        }
+    }, options), std::runtime_error, "runtime_error exception must be rethrown from the tasks")
+}
+
+void DirectedRootedTreeTest::algo_ancestor_index()
+{
+    typedef DirectedRootedTree<int>::TreeNode TreeNode;
+
+    DirectedRootedTree<int> tree = build_random_tree(3000, 50, 44);
+    tree_algorithms::AncestorIndex<int> index(tree);
+
+    std::vector<const TreeNode*> nodes;
+    for (DirectedRootedTree<int>::ConstIterator iter = tree.cbegin(); iter != tree.cend(); ++iter)
+    {
+        nodes.push_back(iter.current_node());
+    }
+    auto ancestors = [](const TreeNode* node)
+    {
+        std::vector<const TreeNode*> path;
+        for (; node; node = node->parent())
+        {
+            path.push_back(node);
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    };
+
+    std::mt19937 generator(8);
+    std::uniform_int_distribution<size_t> distribution(0, nodes.size() - 1);
+    for (int i = 0; i != 2000; ++i)
+    {
+        const TreeNode* left = nodes[distribution(generator)];
+        const TreeNode* right = i % 4 == 0 ? left : nodes[distribution(generator)];
+        const std::vector<const TreeNode*> left_path = ancestors(left);
+        const std::vector<const TreeNode*> right_path = ancestors(right);
+
+        size_t common_length = 0;
+        while (common_length != std::min(left_path.size(), right_path.size())
+               && left_path[common_length] == right_path[common_length])
+        {
+            ++common_length;
+        }
+        QCOMPARE(index.lowest_common_ancestor(left, right), left_path[common_length - 1]);
+        QCOMPARE(index.is_ancestor(left, right), left != right && common_length == left_path.size());
+        QCOMPARE(index.depth(right), right_path.size() - 1);
+    }
+
+    // Edits make the index stale until it is rebuilt
+    TreeNode* leaf = tree.add_child(tree.root()->children().back().get(), -1);
+    QVERIFY(!index.valid());
+    ASSERT_THROWS(index.depth(leaf), std::logic_error, "logic_error exception must be thrown on a stale index")
+    index.rebuild();
+    QVERIFY(index.valid());
+    QCOMPARE(index.depth(leaf), 2ul);
+    QVERIFY(index.is_ancestor(tree.root(), leaf));
+    QVERIFY(!index.is_ancestor(leaf, tree.root()));
+
+    TreeNode* removed = tree.root()->children().front().get();
+    const std::vector<TreeNode*> grandchildren = [removed]()
+    {
+        std::vector<TreeNode*> children;
+        for (const DirectedRootedTree<int>::node_ptr_t& child : removed->children())
+        {
+            children.push_back(child.get());
+        }
+        return children;
+    }();
+    tree.remove_node(removed);
+    QVERIFY(!index.valid());
+    index.rebuild();
+    for (TreeNode* child : grandchildren)
+    {
+        QCOMPARE(index.depth(child), 1ul);
+        QCOMPARE(index.lowest_common_ancestor(child, leaf), static_cast<const TreeNode*>(tree.root()));
+    }
+
+    const DirectedRootedTree<int> other_tree(0);
+    ASSERT_THROWS(index.depth(other_tree.root()), std::out_of_range,
+                  "out_of_range exception must be thrown for a node of another tree")
+}
+
+void DirectedRootedTreeTest::algo_value_index()
+{
+    typedef DirectedRootedTree<std::string>::TreeNode TreeNode;
+
+    DirectedRootedTree<std::string> tree("plan");
+    TreeNode* design = tree.add_child(tree.root(), "design");
+    TreeNode* build = tree.add_child(tree.root(), "build");
+    tree.add_child(design, "review");
+
+    tree_algorithms::ValueIndex<std::string> index(tree);
+    QCOMPARE(index.keys_count(), 4ul);
+    QCOMPARE(index.find("design"), design);
+    QVERIFY(index.contains("review"));
+    QVERIFY(!index.contains("deploy"));
+    QVERIFY(index.find("deploy") == nullptr);
+
+    TreeNode* deploy = tree.add_child(build, "deploy");
+    QCOMPARE(index.find("deploy"), deploy);
+
+    // Duplicates are kept in the order of indexing
+    TreeNode* second_review = tree.add_child(build, "review");
+    QCOMPARE(index.count("review"), 2ul);
+    QCOMPARE(index.find("review"), design->children().front().get());
+    QCOMPARE(index.find_all("review").back(), second_review);
+    tree_algorithms::ValueIndex<std::string> last_index(tree, tree_algorithms::duplicate_keys::last);
+    QCOMPARE(last_index.find("review"), second_review);
+    tree_algorithms::ValueIndex<std::string> unique_index(tree, tree_algorithms::duplicate_keys::error);
+    ASSERT_THROWS(unique_index.find("review"), std::runtime_error,
+                  "runtime_error exception must be thrown on finding a duplicated key")
+    QCOMPARE(unique_index.find("deploy"), deploy);
+
+    tree.set_value(second_review, "test");
+    QCOMPARE(index.count("review"), 1ul);
+    QCOMPARE(index.find("test"), second_review);
+    QCOMPARE(unique_index.find("review"), design->children().front().get());
+
+    // Removed duplicates keep the order of the other ones
+    TreeNode* first_check = tree.add_child(deploy, "check");
+    TreeNode* second_check = tree.add_child(deploy, "check");
+    TreeNode* third_check = tree.add_child(deploy, "check");
+    TreeNode* fourth_check = tree.add_child(deploy, "check");
+    tree.remove_node(first_check);
+    QCOMPARE(index.find("check"), second_check);
+    tree.remove_node(third_check);
+    const std::vector<TreeNode*> checks = { second_check, fourth_check };
+    QCOMPARE(index.find_all("check"), checks);
+    QCOMPARE(last_index.find("check"), fourth_check);
+    tree.remove_nodes(checks);
+    QVERIFY(!index.contains("check"));
+
+    tree.remove_node(design);
+    QVERIFY(!index.contains("design"));
+    QCOMPARE(index.find("review")->parent(), static_cast<const TreeNode*>(tree.root()));
+
+    std::vector<TreeNode*> removed = { build, deploy };
+    tree.remove_nodes(removed);
+    QVERIFY(!index.contains("build"));
+    QVERIFY(!index.contains("deploy"));
+    QCOMPARE(index.keys_count(), 3ul);
+
+    // Keys taken from a part of the value
+    tree_algorithms::ValueIndex<std::string, char> first_letters(tree, [](const std::string& value)
+    {
+        return value.front();
+    });
+    QCOMPARE(first_letters.count('t'), 1ul);
+    QCOMPARE(first_letters.find('p'), tree.root());
+
+    DirectedRootedTree<std::string> moved(std::move(tree));
+    QCOMPARE(index.keys_count(), 0ul);
+}
+
+DirectedRootedTree<int> DirectedRootedTreeTest::build_random_tree(size_t nodes_count,
+                                                                  size_t max_parent_distance,
+                                                                  unsigned seed) const
+{
+    std::mt19937 generator(seed);
+    DirectedRootedTree<int> tree(0);
+    tree.reserve(nodes_count);
+    std::vector<DirectedRootedTree<int>::TreeNode*> nodes(1, tree.root());
+    for (size_t i = 1; i < nodes_count; ++i)
+    {
+        size_t min_parent = i > max_parent_distance ? i - max_parent_distance : 0;
+        std::uniform_int_distribution<size_t> distribution(min_parent, i - 1);
+        nodes.push_back(tree.add_child(nodes[distribution(generator)], static_cast<int>(i)));
+    }
+    return tree;
 }
 
 DirectedRootedTree<int> DirectedRootedTreeTest::build_multilayer_tree(std::vector<int>& nodes_values_depth_first) const
@@ -582,6 +2299,10 @@ bool DirectedRootedTreeTest::is_node_consistent(const typename DirectedRootedTre
         {
             return false;
         }
+        if (node->children()[child->child_index()] != child)
+        {
+            return false;
+        }
         if (!is_node_consistent<T>(child.get()))
         {
             return false;
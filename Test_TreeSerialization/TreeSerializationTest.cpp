@@ -37,6 +37,9 @@ private Q_SLOTS:
     void read_unbalanced_tree_data();
     void read_unbalanced_tree();
 
+    void persistent_tree_data();
+    void persistent_tree();
+
 private:
     template <typename T>
     DirectedRootedTree<T> build_empty_tree(const std::vector<T>& data,
@@ -210,6 +213,29 @@ void TreeSerializationTest::read_unbalanced_tree()
     QVERIFY(tree == read_tree);
 }
 
+void TreeSerializationTest::persistent_tree_data()
+{
+    write_unbalanced_tree_data();
+}
+
+void TreeSerializationTest::persistent_tree()
+{
+    QFETCH(std::vector<int>, data);
+
+    std::string serialized;
+    DirectedRootedTree<int> tree = build_unbalanced_tree(data, serialized);
+    PersistentDirectedRootedTree<int> persistent_tree(tree);
+
+    std::stringstream stream;
+    TreeSerialization::write_tree(stream, persistent_tree);
+    QCOMPARE(serialized, stream.str());
+
+    std::stringstream read_stream(serialized);
+    PersistentDirectedRootedTree<int> read_tree = TreeSerialization::read_persistent_tree<int>(read_stream);
+    QVERIFY(persistent_tree == read_tree);
+    QVERIFY(tree == read_tree.to_tree());
+}
+
 template <typename T>
 DirectedRootedTree<T>
 TreeSerializationTest::build_empty_tree(const std::vector<T>& data,
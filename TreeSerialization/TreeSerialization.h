@@ -3,37 +3,43 @@
 
 #include <iostream>
 #include <unordered_map>
+#include <vector>
 
 #include "DirectedRootedTree.h"
+#include "PersistentDirectedRootedTree.h"
 
 namespace TreeSerialization
 {
 
-// TODO: use const reference
 // TODO: change function signature to return std::ostream
 template <typename T>
-void write_tree(std::ostream& stream,
-                DirectedRootedTree<T>& tree
-                /*!< Non-const reference because there is no const Iterator in DirectedRootedTree */);
+void write_tree(std::ostream& stream, const DirectedRootedTree<T>& tree);
 
 // TODO: change function signature to return std::istream
 template <typename T>
 DirectedRootedTree<T> read_tree(std::istream& stream);
 
+// Same format as for DirectedRootedTree
+template <typename T>
+void write_tree(std::ostream& stream, const PersistentDirectedRootedTree<T>& tree);
+
+template <typename T>
+PersistentDirectedRootedTree<T> read_persistent_tree(std::istream& stream);
+
 }
 
 template <typename T>
-void TreeSerialization::write_tree(std::ostream& stream, DirectedRootedTree<T>& tree)
+void TreeSerialization::write_tree(std::ostream& stream, const DirectedRootedTree<T>& tree)
 {
     stream.exceptions(stream.exceptions() | std::ios_base::failbit | std::ios_base::badbit);
 
-    typename DirectedRootedTree<T>::Iterator iter = tree.begin();
+    typename DirectedRootedTree<T>::ConstIterator iter = tree.cbegin();
 
     size_t current_node_index = 0;
-    std::unordered_map<typename DirectedRootedTree<T>::TreeNode*, size_t> nodes_indexes(tree.size());
+    std::unordered_map<const typename DirectedRootedTree<T>::TreeNode*, size_t> nodes_indexes(tree.size());
     nodes_indexes[nullptr] = 0;
 
-    while (iter != tree.end())
+    while (iter != tree.cend())
     {
         stream << nodes_indexes[iter.current_node()->parent()] << " " << *iter << std::endl;
         nodes_indexes[iter++.current_node()] = current_node_index++;
@@ -75,4 +81,51 @@ DirectedRootedTree<T> TreeSerialization::read_tree(std::istream& stream)
     return tree;
 }
 
+template <typename T>
+void TreeSerialization::write_tree(std::ostream& stream, const PersistentDirectedRootedTree<T>& tree)
+{
+    stream.exceptions(stream.exceptions() | std::ios_base::failbit | std::ios_base::badbit);
+
+    typedef typename PersistentDirectedRootedTree<T>::Node Node;
+
+    size_t current_node_index = 0;
+    std::vector< std::pair<const Node*, size_t> > pending(1, std::make_pair(tree.root(), size_t(0)));
+    while (!pending.empty())
+    {
+        const Node* node = pending.back().first;
+        stream << pending.back().second << " " << node->value() << std::endl;
+        pending.pop_back();
+
+        for (auto iter = node->children().rbegin(); iter != node->children().rend(); ++iter)
+        {
+            pending.emplace_back(iter->get(), current_node_index);
+        }
+        ++current_node_index;
+    }
+}
+
+template <typename T>
+PersistentDirectedRootedTree<T> TreeSerialization::read_persistent_tree(std::istream& stream)
+{
+    std::vector<T> values;
+    std::vector<size_t> parents;
+
+    size_t parent_node_index;
+    T value;
+    while (stream >> parent_node_index >> value)
+    {
+        if (!values.empty() && parent_node_index >= values.size())
+        {
+            throw std::runtime_error("Inconsistent tree: specified parent not found");
+        }
+        parents.push_back(parent_node_index);
+        values.push_back(value);
+    }
+    if (values.empty())
+    {
+        return PersistentDirectedRootedTree<T>();
+    }
+    return PersistentDirectedRootedTree<T>::from_preorder(values, parents);
+}
+
 #endif // TREESERIALIZATION_H